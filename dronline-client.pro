@@ -48,6 +48,9 @@ HEADERS += \
   src/draudiotrackmetadata.h \
   src/drcharactermovie.h \
   src/drchatlog.h \
+  src/drchatlogdelegate.h \
+  src/drchatlogview.h \
+  src/drchatrecordmodel.h \
   src/drdiscord.h \
   src/dreffectmovie.h \
   src/drevidencedialogue.h \
@@ -56,6 +59,7 @@ HEADERS += \
   src/drmediatester.h \
   src/drmovie.h \
   src/drpacket.h \
+  src/drpacketframer.h \
   src/drpather.h \
   src/drplayerlistentry.h \
   src/drposition.h \
@@ -76,12 +80,19 @@ HEADERS += \
   src/mk2/drplayer.h \
   src/mk2/graphicsspriteitem.h \
   src/mk2/graphicsvideoscreen.h \
+  src/mk2/spritecache.h \
+  src/mk2/spritecacheentry.h \
   src/mk2/spritecachingreader.h \
+  src/mk2/spritedecodescheduler.h \
+  src/mk2/spritediskcache.h \
   src/mk2/spritedynamicreader.h \
+  src/mk2/spriteframecodec.h \
+  src/mk2/spritemappedfile.h \
   src/mk2/spriteplayer.h \
   src/mk2/spritereader.h \
   src/mk2/spritereadersynchronizer.h \
   src/mk2/spriteseekingreader.h \
+  src/mk2/spriteticker.h \
   src/mk2/spriteviewer.h \
   src/modules/background/background_data.h \
   src/modules/background/background_reader.h \
@@ -90,8 +101,10 @@ HEADERS += \
   src/modules/character/character_data_reader.h \
   src/modules/character/legacy_character_reader.h \
   src/modules/character/outfit_reader.h \
-  src/modules/debug/time_debugger.h \
+  src/modules/debug/profiler.h \
+  src/modules/files/asset_index.h \
   src/modules/files/image_loader.h \
+  src/modules/files/ini_cache.h \
   src/modules/globals/dro_math.h \
   src/modules/json/animation_reader.h \
   src/modules/json/json_reader.h \
@@ -107,9 +120,11 @@ HEADERS += \
   src/modules/managers/evidence_manager.h \
   src/modules/managers/game_manager.h \
   src/modules/managers/localization_manager.h \
+  src/modules/managers/memory_manager.h \
   src/modules/managers/notify_manager.h \
   src/modules/managers/pair_manager.h \
   src/modules/managers/pathing_manager.h \
+  src/modules/managers/preload_manager.h \
   src/modules/managers/replay_manager.h \
   src/modules/managers/scene_manager.h \
   src/modules/managers/variable_manager.h \
@@ -179,6 +194,9 @@ SOURCES += \
   src/draudiotrackmetadata.cpp \
   src/drcharactermovie.cpp \
   src/drchatlog.cpp \
+  src/drchatlogdelegate.cpp \
+  src/drchatlogview.cpp \
+  src/drchatrecordmodel.cpp \
   src/dreffectmovie.cpp \
   src/drevidencedialogue.cpp \
   src/drgraphicscene.cpp \
@@ -186,6 +204,7 @@ SOURCES += \
   src/drmediatester.cpp \
   src/drmovie.cpp \
   src/drpacket.cpp \
+  src/drpacketframer.cpp \
   src/drpather.cpp \
   src/drplayerlistentry.cpp \
   src/drposition.cpp \
@@ -209,10 +228,17 @@ SOURCES += \
   src/mk2/drplayer.cpp \
   src/mk2/graphicsspriteitem.cpp \
   src/mk2/graphicsvideoscreen.cpp \
+  src/mk2/spritecache.cpp \
+  src/mk2/spritecacheentry.cpp \
   src/mk2/spritecachingreader.cpp \
+  src/mk2/spritedecodescheduler.cpp \
+  src/mk2/spritediskcache.cpp \
   src/mk2/spritedynamicreader.cpp \
+  src/mk2/spriteframecodec.cpp \
+  src/mk2/spritemappedfile.cpp \
   src/mk2/spriteplayer.cpp \
   src/mk2/spriteseekingreader.cpp \
+  src/mk2/spriteticker.cpp \
   src/modules/background/background_data.cpp \
   src/modules/background/background_reader.cpp \
   src/modules/background/legacy_background_reader.cpp \
@@ -220,8 +246,10 @@ SOURCES += \
   src/modules/character/character_data_reader.cpp \
   src/modules/character/legacy_character_reader.cpp \
   src/modules/character/outfit_reader.cpp \
-  src/modules/debug/time_debugger.cpp \
+  src/modules/debug/profiler.cpp \
+  src/modules/files/asset_index.cpp \
   src/modules/files/image_loader.cpp \
+  src/modules/files/ini_cache.cpp \
   src/modules/globals/dro_math.cpp \
   src/modules/json/animation_reader.cpp \
   src/modules/json/json_reader.cpp \
@@ -237,9 +265,11 @@ SOURCES += \
   src/modules/managers/evidence_manager.cpp \
   src/modules/managers/game_manager.cpp \
   src/modules/managers/localization_manager.cpp \
+  src/modules/managers/memory_manager.cpp \
   src/modules/managers/notify_manager.cpp \
   src/modules/managers/pair_manager.cpp \
   src/modules/managers/pathing_manager.cpp \
+  src/modules/managers/preload_manager.cpp \
   src/modules/managers/replay_manager.cpp \
   src/modules/managers/scene_manager.cpp \
   src/modules/managers/variable_manager.cpp \
@@ -11,6 +11,7 @@
 #include "drserversocket.h"
 #include "file_functions.h"
 #include "lobby.h"
+#include "mk2/spritediskcache.h"
 #include "theme.h"
 #include "drtheme.h"
 #include "version.h"
@@ -23,6 +24,8 @@
 #include <modules/managers/character_manager.h>
 #include <modules/managers/game_manager.h>
 #include <modules/managers/localization_manager.h>
+#include <modules/managers/preload_manager.h>
+#include <modules/managers/replay_manager.h>
 
 #include <modules/theme/thememanager.h>
 
@@ -83,6 +86,10 @@ AOApplication::AOApplication(int &argc, char **argv)
 AOApplication::~AOApplication()
 {
   qInfo() << "Closing Danganronpa Online...";
+  ReplayManager::get().RecordingFinalize();
+  mk2::SpriteDiskCache::stop_warm_up();
+  // the decode scheduler is torn down before the manager
+  PreloadManager::get().CancelWarmUp();
   destruct_lobby();
   destruct_courtroom();
 }
@@ -1,6 +1,7 @@
 #include "aoblipplayer.h"
 
 #include "aoapplication.h"
+#include "modules/debug/profiler.h"
 
 const int AOBlipPlayer::BLIP_COUNT = 5;
 
@@ -18,11 +19,18 @@ void AOBlipPlayer::set_blips(QString p_blip)
 
   m_name = p_blip;
   m_file = ao_app->get_sfx_noext_path(m_name.value());
+  m_family->load_sample(m_file.value());
 }
 
 void AOBlipPlayer::blip_tick()
 {
   if (!m_file.has_value())
     return;
-  m_family->play_stream(m_file.value());
+
+  DR_PROFILE_SCOPE("AOBlipPlayer blip");
+  if (!m_family->play_sample(m_file.value()))
+  {
+    // files that could not be loaded as a sample still play the way they used to
+    m_family->play_stream(m_file.value());
+  }
 }
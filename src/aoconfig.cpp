@@ -4,7 +4,12 @@
 #include "datatypes.h"
 #include "draudioengine.h"
 #include "drpather.h"
-#include "mk2/spritedynamicreader.h"
+#include "mk2/spritecache.h"
+#include "mk2/spritediskcache.h"
+#include "mk2/spriteseekingreader.h"
+#include "mk2/spriteticker.h"
+#include "modules/managers/memory_manager.h"
+#include "modules/managers/preload_manager.h"
 #include "modules/managers/scene_manager.h"
 #include "modules/managers/localization_manager.h"
 
@@ -98,6 +103,13 @@ private:
   QMap<int, bool> sprite_caching;
   int loading_bar_delay;
   int caching_threshold;
+  bool play_through_sync;
+  int sprite_cache_size;
+  int seeking_index_size;
+  bool frame_compression;
+  int sprite_disk_cache_size;
+  int speculative_preload_size;
+  bool frame_dropping;
 
   // audio
   std::optional<QString> favorite_device_driver;
@@ -215,7 +227,21 @@ void AOConfigPrivate::load_file()
   system_memory_threshold = qBound(10, cfg.value("system_memory_threshold", 50).toInt(), 80);
   loading_bar_delay = qBound(0, cfg.value("loading_bar_delay", 500).toInt(), 2000);
   caching_threshold = qBound(0, cfg.value("caching_threshold", 50).toInt(), 100);
-  mk2::SpriteDynamicReader::set_system_memory_threshold(system_memory_threshold);
+  play_through_sync = cfg.value("play_through_sync", true).toBool();
+  sprite_cache_size = qBound(0, cfg.value("sprite_cache_size", 256).toInt(), 4096);
+  MemoryManager::get().SetProcessCapPercent(system_memory_threshold);
+  mk2::SpriteCache::set_byte_budget(qint64(sprite_cache_size) * 1024 * 1024);
+  seeking_index_size = qBound(0, cfg.value("seeking_index_size", 16).toInt(), 512);
+  mk2::SpriteSeekingReader::set_index_memory_cap(qint64(seeking_index_size) * 1024 * 1024);
+  frame_compression = cfg.value("frame_compression", false).toBool();
+  mk2::SpriteCache::set_frame_compression_enabled(frame_compression);
+  sprite_disk_cache_size = qBound(0, cfg.value("sprite_disk_cache_size", 1024).toInt(), 16384);
+  mk2::SpriteDiskCache::set_byte_budget(qint64(sprite_disk_cache_size) * 1024 * 1024);
+  mk2::SpriteDiskCache::set_directory(DRPather::get_application_path() + BASE_SPRITE_CACHE_DIR);
+  speculative_preload_size = qBound(0, cfg.value("speculative_preload_size", 128).toInt(), 1024);
+  PreloadManager::get().SetByteBudget(qint64(speculative_preload_size) * 1024 * 1024);
+  frame_dropping = cfg.value("frame_dropping", true).toBool();
+  mk2::SpriteTicker::set_frame_dropping_enabled(frame_dropping);
 
   // audio
   if (cfg.contains("favorite_device_driver"))
@@ -329,6 +355,13 @@ void AOConfigPrivate::save_file()
   cfg.setValue("system_memory_threshold", system_memory_threshold);
   cfg.setValue("loading_bar_delay", loading_bar_delay);
   cfg.setValue("caching_threshold", caching_threshold);
+  cfg.setValue("play_through_sync", play_through_sync);
+  cfg.setValue("sprite_cache_size", sprite_cache_size);
+  cfg.setValue("seeking_index_size", seeking_index_size);
+  cfg.setValue("frame_compression", frame_compression);
+  cfg.setValue("sprite_disk_cache_size", sprite_disk_cache_size);
+  cfg.setValue("speculative_preload_size", speculative_preload_size);
+  cfg.setValue("frame_dropping", frame_dropping);
 
   // audio
   if (favorite_device_driver.has_value())
@@ -667,6 +700,41 @@ int AOConfig::caching_threshold() const
   return d->caching_threshold;
 }
 
+bool AOConfig::play_through_sync_enabled() const
+{
+  return d->play_through_sync;
+}
+
+int AOConfig::sprite_cache_size() const
+{
+  return d->sprite_cache_size;
+}
+
+int AOConfig::seeking_index_size() const
+{
+  return d->seeking_index_size;
+}
+
+bool AOConfig::frame_compression_enabled() const
+{
+  return d->frame_compression;
+}
+
+int AOConfig::sprite_disk_cache_size() const
+{
+  return d->sprite_disk_cache_size;
+}
+
+int AOConfig::speculative_preload_size() const
+{
+  return d->speculative_preload_size;
+}
+
+bool AOConfig::frame_dropping_enabled() const
+{
+  return d->frame_dropping;
+}
+
 std::optional<QString> AOConfig::favorite_device_driver() const
 {
   return d->favorite_device_driver;
@@ -1089,7 +1157,7 @@ void AOConfig::set_system_memory_threshold(int p_percent)
   if (d->system_memory_threshold == p_percent)
     return;
   d->system_memory_threshold = p_percent;
-  mk2::SpriteDynamicReader::set_system_memory_threshold(p_percent);
+  MemoryManager::get().SetProcessCapPercent(p_percent);
   d->invoke_signal("system_memory_threshold_changed", Q_ARG(int, p_percent));
 }
 
@@ -1119,6 +1187,72 @@ void AOConfig::set_caching_threshold(int p_percent)
   d->invoke_signal("caching_threshold_changed", Q_ARG(int, p_percent));
 }
 
+void AOConfig::set_play_through_sync(bool p_enabled)
+{
+  if (d->play_through_sync == p_enabled)
+    return;
+  d->play_through_sync = p_enabled;
+  d->invoke_signal("play_through_sync_changed", Q_ARG(bool, p_enabled));
+}
+
+void AOConfig::set_sprite_cache_size(int p_megabytes)
+{
+  p_megabytes = qBound(0, p_megabytes, 4096);
+  if (d->sprite_cache_size == p_megabytes)
+    return;
+  d->sprite_cache_size = p_megabytes;
+  mk2::SpriteCache::set_byte_budget(qint64(p_megabytes) * 1024 * 1024);
+  d->invoke_signal("sprite_cache_size_changed", Q_ARG(int, p_megabytes));
+}
+
+void AOConfig::set_seeking_index_size(int p_megabytes)
+{
+  p_megabytes = qBound(0, p_megabytes, 512);
+  if (d->seeking_index_size == p_megabytes)
+    return;
+  d->seeking_index_size = p_megabytes;
+  mk2::SpriteSeekingReader::set_index_memory_cap(qint64(p_megabytes) * 1024 * 1024);
+  d->invoke_signal("seeking_index_size_changed", Q_ARG(int, p_megabytes));
+}
+
+void AOConfig::set_frame_compression(bool p_enabled)
+{
+  if (d->frame_compression == p_enabled)
+    return;
+  d->frame_compression = p_enabled;
+  mk2::SpriteCache::set_frame_compression_enabled(p_enabled);
+  d->invoke_signal("frame_compression_changed", Q_ARG(bool, p_enabled));
+}
+
+void AOConfig::set_sprite_disk_cache_size(int p_megabytes)
+{
+  p_megabytes = qBound(0, p_megabytes, 16384);
+  if (d->sprite_disk_cache_size == p_megabytes)
+    return;
+  d->sprite_disk_cache_size = p_megabytes;
+  mk2::SpriteDiskCache::set_byte_budget(qint64(p_megabytes) * 1024 * 1024);
+  d->invoke_signal("sprite_disk_cache_size_changed", Q_ARG(int, p_megabytes));
+}
+
+void AOConfig::set_speculative_preload_size(int p_megabytes)
+{
+  p_megabytes = qBound(0, p_megabytes, 1024);
+  if (d->speculative_preload_size == p_megabytes)
+    return;
+  d->speculative_preload_size = p_megabytes;
+  PreloadManager::get().SetByteBudget(qint64(p_megabytes) * 1024 * 1024);
+  d->invoke_signal("speculative_preload_size_changed", Q_ARG(int, p_megabytes));
+}
+
+void AOConfig::set_frame_dropping(bool p_enabled)
+{
+  if (d->frame_dropping == p_enabled)
+    return;
+  d->frame_dropping = p_enabled;
+  mk2::SpriteTicker::set_frame_dropping_enabled(p_enabled);
+  d->invoke_signal("frame_dropping_changed", Q_ARG(bool, p_enabled));
+}
+
 void AOConfig::set_favorite_device_driver(QString p_device_driver)
 {
   if (d->favorite_device_driver.has_value() && d->favorite_device_driver.value() == p_device_driver)
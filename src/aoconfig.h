@@ -64,6 +64,13 @@ public:
   int system_memory_threshold() const;
   int loading_bar_delay() const;
   int caching_threshold() const;
+  bool play_through_sync_enabled() const;
+  int sprite_cache_size() const;
+  int seeking_index_size() const;
+  bool frame_compression_enabled() const;
+  int sprite_disk_cache_size() const;
+  int speculative_preload_size() const;
+  bool frame_dropping_enabled() const;
 
   // audio
   std::optional<QString> favorite_device_driver() const;
@@ -136,6 +143,13 @@ public slots:
   void set_system_memory_threshold(int percent);
   void set_loading_bar_delay(int delay);
   void set_caching_threshold(int percent);
+  void set_play_through_sync(bool enabled);
+  void set_sprite_cache_size(int megabytes);
+  void set_seeking_index_size(int megabytes);
+  void set_frame_compression(bool enabled);
+  void set_sprite_disk_cache_size(int megabytes);
+  void set_speculative_preload_size(int megabytes);
+  void set_frame_dropping(bool enabled);
 
   // audio
   void set_favorite_device_driver(QString p_device_driver);
@@ -208,6 +222,13 @@ signals:
   void system_memory_threshold_changed(int);
   void loading_bar_delay_changed(int);
   void caching_threshold_changed(int);
+  void play_through_sync_changed(bool);
+  void sprite_cache_size_changed(int);
+  void seeking_index_size_changed(int);
+  void frame_compression_changed(bool);
+  void sprite_disk_cache_size_changed(int);
+  void speculative_preload_size_changed(int);
+  void frame_dropping_changed(bool);
 
   // audio
   void favorite_device_changed(QString);
@@ -7,6 +7,7 @@ const QString BASE_PACKAGES_INI = "packages.ini";
 const QString BASE_SERVER_BROWSER_INI = "server_browser.ini";
 const QString BASE_FAVORITE_SERVERS_INI = "favorite_servers.ini";
 const QString BASE_SERVERLIST_TXT = "serverlist.txt";
+const QString BASE_SPRITE_CACHE_DIR = "/base/cache/sprites";
 
 const QString CHARACTER_CHAR_INI = "char.ini";
 const QString CHARACTER_CHAR_JSON = "char.json";
@@ -7,6 +7,7 @@ extern const QString BASE_PACKAGES_INI;
 extern const QString BASE_SERVER_BROWSER_INI;
 extern const QString BASE_FAVORITE_SERVERS_INI;
 extern const QString BASE_SERVERLIST_TXT;
+extern const QString BASE_SPRITE_CACHE_DIR;
 
 extern const QString CHARACTER_CHAR_INI;
 extern const QString CHARACTER_CHAR_JSON;
@@ -3,17 +3,19 @@
 #include "modules/theme/thememanager.h"
 #include "aoapplication.h"
 #include "aoblipplayer.h"
-#include "modules/debug/time_debugger.h"
+#include "modules/debug/profiler.h"
 #include "aobutton.h"
 #include "aoconfig.h"
 #include "aoimagedisplay.h"
 #include "aomusicplayer.h"
 #include "modules/managers/character_manager.h"
+#include "modules/files/ini_cache.h"
 #include "aonotearea.h"
 #include "aonotepicker.h"
 #include "aosfxplayer.h"
 #include "modules/managers/emotion_manager.h"
 #include "modules/managers/pair_manager.h"
+#include "modules/managers/preload_manager.h"
 #include "aoshoutplayer.h"
 #include "aosystemplayer.h"
 #include "aotimer.h"
@@ -23,6 +25,9 @@
 #include "draudiotrackmetadata.h"
 #include "drcharactermovie.h"
 #include "drchatlog.h"
+#include "drchatlogdelegate.h"
+#include "drchatlogview.h"
+#include "drchatrecordmodel.h"
 #include "drdiscord.h"
 #include "drtheme.h"
 #include "dreffectmovie.h"
@@ -78,6 +83,7 @@ Courtroom::Courtroom(AOApplication *p_ao_app, QWidget *parent)
 
   m_preloader_sync = new mk2::SpriteReaderSynchronizer(this);
   m_preloader_sync->set_threshold(ao_config->caching_threshold());
+  m_preloader_sync->set_play_through(ao_config->play_through_sync_enabled());
 
   connect(ao_app, SIGNAL(reload_theme()), this, SLOT(reload_theme()));
   connect(ao_app, SIGNAL(reload_character()), this, SLOT(load_character()));
@@ -127,7 +133,7 @@ void Courtroom::set_music_list(QStringList p_music_list)
 
 void Courtroom::setup_courtroom()
 {
-  TimeDebugger::get().StartTimer("Courtroom Setup");
+  DR_PROFILE_SCOPE("Courtroom Setup");
   load_shouts();
 
   load_free_blocks();
@@ -168,7 +174,6 @@ void Courtroom::setup_courtroom()
   }
 
   construct_playerlist_layout();
-  TimeDebugger::get().EndTimer("Courtroom Setup");
   PairManager::get().ThemeReload();
 }
 
@@ -339,7 +344,7 @@ void Courtroom::enter_courtroom(int p_cid)
 
   CharacterManager::get().SwitchCharacter(l_chr_name);
   AnimationManager::get().CachePlayerAnimations();
-  CharacterData *l_selectedCharacter = CharacterManager::get().p_SelectedCharacter;
+  CharacterData::ptr l_selectedCharacter = CharacterManager::get().p_SelectedCharacter;
 
 
   VariableManager::get().setVariable("player_chara", l_chr_name);
@@ -550,6 +555,11 @@ DRAreaBackground Courtroom::get_background()
 void Courtroom::set_background(DRAreaBackground p_background)
 {
   ReplayManager::get().RecordChangeBackground(p_background.background);
+  // the server sends the background on every area change; speakers of the previous area are unlikely to follow
+  if (p_background.background != m_background.background)
+  {
+    PreloadManager::get().ResetHistory();
+  }
   m_background = p_background;
 
   QStringList l_background_list{m_background.background};
@@ -1005,6 +1015,7 @@ void Courtroom::handle_acknowledged_ms()
 
 void Courtroom::next_chatmessage(QStringList p_chatmessage)
 {
+  DR_PROFILE_FUNCTION();
   if (p_chatmessage.length() < MINIMUM_MESSAGE_SIZE)
   {
     return;
@@ -1016,23 +1027,23 @@ void Courtroom::next_chatmessage(QStringList p_chatmessage)
   }
 
 
-  m_CurrentMessageData = SceneManager::get().ProcessIncomingMessage(p_chatmessage);
+  // logged as soon as it arrives, shown once the messages before it are done
+  ICMessageData l_message_data(p_chatmessage, true);
 
-  const int l_message_chr_id = m_CurrentMessageData->m_CharacterServerId;
+  const int l_message_chr_id = l_message_data.m_CharacterServerId;
   const bool l_system_speaking = l_message_chr_id == SpectatorId;
 
-  PairManager::get().UpdatePairData();
-  ReplayManager::get().RecordMessageIC(m_CurrentMessageData);
+  ReplayManager::get().RecordMessageIC(&l_message_data);
 
-  CharacterData *l_speakerData = CharacterManager::get().ReadCharacter(m_CurrentMessageData->m_CharacterFolder);
+  CharacterData::ptr l_speakerData = CharacterManager::get().ReadCharacter(l_message_data.m_CharacterFolder);
 
-  QString l_showname = m_CurrentMessageData->m_ShowName;
+  QString l_showname = l_message_data.m_ShowName;
   if (l_showname.isEmpty() && !l_system_speaking)
   {
     l_showname = l_speakerData->getShowname();
   }
 
-  const QString l_message = QString(m_CurrentMessageData->m_MessageContents).remove(QRegularExpression("(?<!\\\\)(\\{|\\})")).replace(QRegularExpression("\\\\(\\{|\\})"), "\\1");
+  const QString l_message = QString(l_message_data.m_MessageContents).remove(QRegularExpression("(?<!\\\\)(\\{|\\})")).replace(QRegularExpression("\\\\(\\{|\\})"), "\\1");
 
   if (l_message_chr_id == SpectatorId)
   {
@@ -1041,7 +1052,7 @@ void Courtroom::next_chatmessage(QStringList p_chatmessage)
   }
   else if (l_message_chr_id >= 0 && l_message_chr_id < CharacterManager::get().mServerCharacters.length())
   {
-    const int l_client_id = m_CurrentMessageData->m_ClientId;
+    const int l_client_id = l_message_data.m_ClientId;
     append_ic_text(l_showname, l_message, false, false, l_client_id, m_chr_id == l_message_chr_id);
 
     if (ao_config->log_is_recording_enabled() && !l_message.isEmpty())
@@ -1052,20 +1063,142 @@ void Courtroom::next_chatmessage(QStringList p_chatmessage)
 
   { // clear interface if required
     bool l_ok = true;
-    const int l_client_id = m_CurrentMessageData->m_ClientId;
+    const int l_client_id = l_message_data.m_ClientId;
     if (l_ok && l_client_id == ao_app->get_client_id())
     {
       handle_acknowledged_ms();
     }
   }
+
+  if (m_game_state == GameState::Finished && m_chatmessage_queue.isEmpty())
+  {
+    display_chatmessage(p_chatmessage);
+    return;
+  }
+
+  // a message that takes too long gives way, as every message used to
+  m_chatmessage_queue.enqueue(p_chatmessage);
+  if (!m_chatmessage_queue_timer->isActive())
+  {
+    m_chatmessage_queue_timer->start(CHATMESSAGE_MAX_HOLD);
+  }
+  preload_queued_chatmessages();
+}
+
+void Courtroom::display_chatmessage(QStringList p_chatmessage)
+{
+  m_CurrentMessageData = SceneManager::get().ProcessIncomingMessage(p_chatmessage);
+  PairManager::get().UpdatePairData();
+
   SceneManager::get().RenderTransition();
   preload_chatmessage(p_chatmessage);
+
+  if (m_chatmessage_queue.isEmpty())
+  {
+    m_chatmessage_queue_timer->stop();
+  }
+  else
+  {
+    m_chatmessage_queue_timer->start(CHATMESSAGE_MAX_HOLD);
+  }
+  preload_queued_chatmessages();
+}
+
+void Courtroom::advance_chatmessage_queue()
+{
+  if (m_chatmessage_queue.isEmpty())
+  {
+    return;
+  }
+  display_chatmessage(m_chatmessage_queue.dequeue());
+}
+
+void Courtroom::preload_queued_chatmessages()
+{
+  DR_PROFILE_FUNCTION();
+  QHash<QString, mk2::SpriteReader::ptr> l_reader_cache;
+  const int l_message_count = qMin(CHATMESSAGE_LOOKAHEAD, m_chatmessage_queue.length());
+  for (int i = 0; i < l_message_count; ++i)
+  {
+    const ICMessageData l_message_data(m_chatmessage_queue.at(i), true);
+    const QMap<ViewportSprite, QString> l_file_list = get_queued_sprite_files(l_message_data);
+    for (auto it = l_file_list.cbegin(); it != l_file_list.cend(); ++it)
+    {
+      const QString &l_file_name = it.value();
+      if (l_file_name.isEmpty() || l_reader_cache.contains(l_file_name) || !ao_config->sprite_caching_enabled(viewport_sprite_to_sprite_category(it.key())))
+      {
+        continue;
+      }
+
+      mk2::SpriteReader::ptr l_reader = m_lookahead_reader_cache.value(l_file_name);
+      if (!l_reader)
+      {
+        l_reader = create_viewport_reader(it.key(), l_file_name);
+      }
+      l_reader_cache.insert(l_file_name, l_reader);
+    }
+  }
+  // readers of messages that were shown or dropped are released here
+  m_lookahead_reader_cache = std::move(l_reader_cache);
+}
+
+QMap<ViewportSprite, QString> Courtroom::get_queued_sprite_files(const ICMessageData &p_message_data)
+{
+  QMap<ViewportSprite, QString> l_file_list;
+  const QString l_position_id = p_message_data.m_AreaPosition;
+  l_file_list.insert(ViewportStageBack, SceneManager::get().getBackgroundPath(l_position_id));
+  l_file_list.insert(ViewportStageFront, SceneManager::get().getForegroundPath(l_position_id));
+
+  QString l_character = p_message_data.m_CharacterFolder;
+  if (!p_message_data.m_CharacterOutfit.isEmpty())
+  {
+    l_character = l_character + "/outfits/" + p_message_data.m_CharacterOutfit;
+  }
+  l_file_list.insert(ViewportCharacterPre, ao_app->get_character_sprite_pre_path(l_character, p_message_data.m_PreAnimation));
+  l_file_list.insert(ViewportCharacterIdle, ao_app->get_character_sprite_idle_path(l_character, p_message_data.m_CharacterEmotion));
+  l_file_list.insert(ViewportCharacterTalk, ao_app->get_character_sprite_talk_path(l_character, p_message_data.m_CharacterEmotion));
+  if (!p_message_data.m_PairCharacterFolder.isEmpty())
+  {
+    l_file_list.insert(ViewportPairCharacterIdle, ao_app->get_character_sprite_idle_path(p_message_data.m_PairCharacterFolder, p_message_data.m_PairCharacterEmotion));
+  }
+  l_file_list.insert(ViewportShout, ao_app->get_shout_sprite_path(l_character, get_shout_name(p_message_data.m_ShoutModifier)));
+
+  const QString l_effect_name = get_effect_name(p_message_data.m_EffectState);
+  if (l_effect_name != "effect_shake")
+  {
+    l_file_list.insert(ViewportEffect, ao_app->get_effect_anim_path(l_effect_name));
+  }
+  return l_file_list;
+}
+
+mk2::SpriteReader::ptr Courtroom::create_viewport_reader(ViewportSprite p_type, QString p_file_name)
+{
+  mk2::SpriteReader::ptr l_reader;
+  const SpriteCategory l_category = viewport_sprite_to_sprite_category(p_type);
+  if (ao_config->sprite_caching_enabled(l_category))
+  {
+    l_reader = mk2::SpriteReader::ptr(new mk2::SpriteDynamicReader);
+  }
+  else
+  {
+    l_reader = mk2::SpriteReader::ptr(new mk2::SpriteSeekingReader);
+  }
+  // decoded behind whatever is on screen, in viewport order
+  l_reader->set_decode_priority(mk2::SpriteDecodeScheduler::Priority::NextMessage);
+  l_reader->set_file_name(p_file_name);
+  return l_reader;
 }
 
 void Courtroom::reset_viewport()
 {
   QStringList l_chatmessage;
 
+  // whatever was queued for the previous area is not shown anymore
+  m_chatmessage_queue.clear();
+  m_chatmessage_queue_timer->stop();
+  m_lookahead_reader_cache.clear();
+  m_game_state = GameState::Finished;
+
   m_CurrentMessageData = SceneManager::get().ProcessIncomingMessage({});
 
   while (l_chatmessage.length() < OPTIMAL_MESSAGE_SIZE)
@@ -1090,6 +1223,7 @@ void Courtroom::reset_viewport()
 
 void Courtroom::preload_chatmessage(QStringList p_contents)
 {
+  DR_PROFILE_FUNCTION();
   cleanup_preload_readers();
   m_loading_timer->stop();
   m_pre_chatmessage = p_contents;
@@ -1109,6 +1243,9 @@ void Courtroom::preload_chatmessage(QStringList p_contents)
   const int l_effect_id = m_CurrentMessageData->m_EffectState;
   const int l_shout_id = m_CurrentMessageData->m_ShoutModifier;
 
+  // before any reader is created, so that warmed sprites are attached to rather than cancelled
+  PreloadManager::get().RecordMessage(l_character, l_emote);
+
   { // backgrounds
     DRPosition l_position = m_position_map.get_position(l_position_id);
     l_file_list.insert(ViewportStageBack, SceneManager::get().getBackgroundPath(l_position_id));
@@ -1152,20 +1289,15 @@ void Courtroom::preload_chatmessage(QStringList p_contents)
     auto l_viewer = m_viewport_viewer_map.value(l_type);
     const QString l_current_file_name = l_viewer->get_file_name();
 
-    // reuse readers when available
+    // reuse readers when available, including those prepared while the message was queued
     mk2::SpriteReader::ptr l_reader = l_viewer->get_reader();
     if (l_file_name != l_current_file_name)
     {
-      const SpriteCategory l_category = viewport_sprite_to_sprite_category(l_type);
-      if (ao_config->sprite_caching_enabled(l_category))
-      {
-        l_reader = mk2::SpriteReader::ptr(new mk2::SpriteDynamicReader);
-      }
-      else
+      l_reader = m_lookahead_reader_cache.take(l_file_name);
+      if (!l_reader)
       {
-        l_reader = mk2::SpriteReader::ptr(new mk2::SpriteSeekingReader);
+        l_reader = create_viewport_reader(l_type, l_file_name);
       }
-      l_reader->set_file_name(l_file_name);
     }
     m_preloader_cache.insert(l_type, l_reader);
     m_preloader_sync->add(l_reader);
@@ -1178,6 +1310,10 @@ void Courtroom::start_chatmessage()
 {
   m_preloader_sync->clear();
   m_reader_cache = std::move(m_preloader_cache);
+  for (const mk2::SpriteReader::ptr &i_reader : qAsConst(m_reader_cache))
+  {
+    i_reader->set_decode_priority(mk2::SpriteDecodeScheduler::Priority::VisibleNow);
+  }
 
   m_loading_timer->stop();
   ui_vp_loading->hide();
@@ -1222,7 +1358,7 @@ void Courtroom::handle_chatmessage()
   // Having an empty showname for system is actually what we expect.
 
 
-  CharacterData *l_speakerData = CharacterManager::get().ReadCharacter(m_CurrentMessageData->m_CharacterFolder);
+  CharacterData::ptr l_speakerData = CharacterManager::get().ReadCharacter(m_CurrentMessageData->m_CharacterFolder);
 
   QString f_showname = m_CurrentMessageData->m_ShowName;
   if (f_showname.isEmpty() && !is_system_speaking)
@@ -1631,107 +1767,44 @@ void Courtroom::load_ic_text_format()
 
 void Courtroom::update_ic_log(bool p_reset_log)
 {
-  if (const int l_record_count = m_ic_record_list.length() + m_ic_record_queue.length(); l_record_count > ao_config->log_max_lines())
-    m_ic_record_list = m_ic_record_list.mid(l_record_count - ao_config->log_max_lines());
-
-  if (p_reset_log || ao_config->log_max_lines() == 1)
-  {
-    if (p_reset_log)
-    {
-      load_ic_text_format();
-      QQueue<DRChatRecord> l_new_queue;
-      dynamic_cast<QList<DRChatRecord> &>(l_new_queue) = std::move(m_ic_record_list);
-      l_new_queue.append(std::move(m_ic_record_queue));
-      m_ic_record_queue = std::move(l_new_queue);
-    }
-
-    ui_ic_chatlog->clear();
-    ui_ic_chatlog->setAlignment(ui_ic_chatlog->get_text_alignment());
-  }
-  bool l_log_is_empty = m_ic_record_list.length() == 0;
-
+  DRChatRecordModel *l_model = ui_ic_chatlog->get_record_model();
   const bool l_topdown_orientation = ao_config->log_is_topdown_enabled();
-  const bool l_use_newline = ao_config->log_format_use_newline_enabled();
-  QTextCursor l_cursor = ui_ic_chatlog->textCursor();
-  const QTextCursor::MoveOperation move_type = l_topdown_orientation ? QTextCursor::End : QTextCursor::Start;
-
-  const QTextCharFormat &l_name_format = m_ic_log_format.name;
-  const QTextCharFormat &l_selfname_format = m_ic_log_format.selfname;
-  const QTextCharFormat &l_message_format = m_ic_log_format.message;
-  const QTextCharFormat &l_system_format = m_ic_log_format.system;
 
   QScrollBar *l_scrollbar = ui_ic_chatlog->verticalScrollBar();
   const int l_scroll_pos = l_scrollbar->value();
   const bool l_is_end_scroll_pos = p_reset_log || (l_topdown_orientation ? l_scroll_pos == l_scrollbar->maximum() : l_scroll_pos == l_scrollbar->minimum());
 
-  while (!m_ic_record_queue.isEmpty())
+  if (p_reset_log)
   {
-    const DRChatRecord l_record = m_ic_record_queue.takeFirst();
-    m_ic_record_list.append(l_record);
-
-    if (!ao_config->log_display_empty_messages_enabled() && l_record.get_message().trimmed().isEmpty())
-      continue;
-
-    if (!ao_config->log_display_music_switch_enabled() && l_record.is_music())
-      continue;
-
-    l_cursor.movePosition(move_type);
+    // display settings are view options; the records are kept as they are
+    load_ic_text_format();
+    DRChatLogDelegate *l_delegate = ui_ic_chatlog->get_delegate();
+    l_delegate->set_name_format(m_ic_log_format.name);
+    l_delegate->set_selfname_format(m_ic_log_format.selfname);
+    l_delegate->set_message_format(m_ic_log_format.message);
+    l_delegate->set_system_format(m_ic_log_format.system);
+    l_delegate->set_display_timestamp(ao_config->log_display_timestamp_enabled());
+    l_delegate->set_display_client_id(ao_config->log_display_client_id_enabled());
+    l_delegate->set_display_self_highlight(ao_config->log_display_self_highlight_enabled());
+    l_delegate->set_use_newline(ao_config->log_format_use_newline_enabled());
+    l_delegate->set_horizontal_alignment(ui_ic_chatlog->get_text_alignment());
 
-    const QString l_linefeed(QChar::LineFeed);
-    if (!l_log_is_empty)
-      l_cursor.insertText(l_linefeed + QString(l_use_newline ? l_linefeed : nullptr), l_message_format);
-    l_log_is_empty = false;
-
-    if (!l_topdown_orientation)
-      l_cursor.movePosition(move_type);
-
-    // self-highlight check
-    const QTextCharFormat &l_target_name_format = (l_record.is_self() && ao_config->log_display_self_highlight_enabled()) ? l_selfname_format : l_name_format;
-
-    if (ao_config->log_display_timestamp_enabled())
-      l_cursor.insertText(QString("[%1] ").arg(l_record.get_timestamp().toString("hh:mm")), l_target_name_format);
-
-    if (l_record.is_system())
-    {
-      l_cursor.insertText(l_record.get_message(), l_system_format);
-    }
-    else
-    {
-      QString l_separator;
-      if (l_use_newline)
-        l_separator = QString(QChar::LineFeed);
-      else if (!l_record.is_music())
-        l_separator = ": ";
-      else
-        l_separator = " ";
-
-      const int l_client_id = l_record.get_client_id();
-      if (l_client_id != NoClientId && ao_config->log_display_client_id_enabled())
-        l_cursor.insertText(QString::number(l_record.get_client_id()) + " | ", l_target_name_format);
-
-      l_cursor.insertText(l_record.get_name() + l_separator, l_target_name_format);
-      l_cursor.insertText(l_record.get_message(), l_message_format);
-    }
+    l_model->set_max_record_count(ao_config->log_max_lines());
+    l_model->set_reversed(!l_topdown_orientation);
+    l_model->set_display_empty_messages(ao_config->log_display_empty_messages_enabled());
+    l_model->set_display_music_switch(ao_config->log_display_music_switch_enabled());
+    ui_ic_chatlog->reset_layout();
   }
 
-  { // remove unneeded blocks
-    const int l_max_block_count = m_ic_record_list.length() * (1 + l_use_newline) + (l_use_newline * (m_ic_record_list.length() - 1)) + !l_topdown_orientation;
-    const QTextCursor::MoveOperation l_orientation = l_topdown_orientation ? QTextCursor::Start : QTextCursor::End;
-    const QTextCursor::MoveOperation l_block_orientation = l_topdown_orientation ? QTextCursor::NextBlock : QTextCursor::PreviousBlock;
-
-    const int l_remove_block_count = ui_ic_chatlog->document()->blockCount() - l_max_block_count;
-    if (l_remove_block_count > 0)
-    {
-      l_cursor.movePosition(l_orientation);
-      for (int i = 0; i < l_remove_block_count; ++i)
-        l_cursor.movePosition(l_block_orientation, QTextCursor::KeepAnchor);
-      l_cursor.removeSelectedText();
-    }
-  }
+  while (!m_ic_record_queue.isEmpty())
+    l_model->append_record(m_ic_record_queue.takeFirst());
 
   if (l_is_end_scroll_pos)
   {
-    l_scrollbar->setValue(l_topdown_orientation ? l_scrollbar->maximum() : l_scrollbar->minimum());
+    if (l_topdown_orientation)
+      ui_ic_chatlog->scrollToBottom();
+    else
+      ui_ic_chatlog->scrollToTop();
   }
 }
 
@@ -1850,6 +1923,14 @@ void Courtroom::setup_chat()
   {
     // since the message is empty, it's technically done ticking
     text_state = 2;
+    if (m_game_state != GameState::Preloading)
+    {
+      m_game_state = GameState::Finished;
+    }
+    if (!m_chatmessage_queue.isEmpty())
+    {
+      m_chatmessage_queue_timer->start(0);
+    }
     return;
   }
 
@@ -2111,6 +2192,18 @@ void Courtroom::post_chatmessage()
     ui_vp_chat_arrow->restart();
     ui_vp_chat_arrow->show();
   }
+
+  if (!m_chatmessage_queue.isEmpty())
+  {
+    m_chatmessage_queue_timer->start(0);
+    return;
+  }
+
+  // warmed sprites would only be decoded into a seeking reader
+  if (ao_config->sprite_caching_enabled(SpriteCharacter))
+  {
+    PreloadManager::get().ScheduleWarmUp();
+  }
 }
 
 void Courtroom::play_sfx()
@@ -2769,10 +2862,16 @@ void Courtroom::on_change_character_clicked()
 
 void Courtroom::load_theme()
 {
+  DR_PROFILE_FUNCTION();
+  const IniCache::Statistics l_ini_statistics = IniCache::get().GetStatistics();
   ao_app->current_theme->InitTheme();
   switchToggle("all");
   setup_courtroom();
   update_background_scene();
+  const IniCache::Statistics l_ini_loaded_statistics = IniCache::get().GetStatistics();
+  qInfo().noquote() << QString("[ini] theme loaded: %1 cache hits, %2 cache misses")
+                           .arg(l_ini_loaded_statistics.hits - l_ini_statistics.hits)
+                           .arg(l_ini_loaded_statistics.misses - l_ini_statistics.misses);
 
   if (ao_app->current_theme->read_config_bool("use_toggles")) ThemeManager::get().ResetTabSelection();
 }
@@ -2812,8 +2911,13 @@ void Courtroom::reload_theme()
 
 void Courtroom::load_character()
 {
+  const IniCache::Statistics l_ini_statistics = IniCache::get().GetStatistics();
   update_iniswap_list();
   enter_courtroom(get_character_id());
+  const IniCache::Statistics l_ini_loaded_statistics = IniCache::get().GetStatistics();
+  qInfo().noquote() << QString("[ini] character loaded: %1 cache hits, %2 cache misses")
+                           .arg(l_ini_loaded_statistics.hits - l_ini_statistics.hits)
+                           .arg(l_ini_loaded_statistics.misses - l_ini_statistics.misses);
 }
 
 void Courtroom::load_audiotracks()
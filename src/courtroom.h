@@ -31,6 +31,7 @@ class AOSystemPlayer;
 class AOTimer;
 class DRCharacterMovie;
 class DRChatLog;
+class DRChatLogView;
 class DRMovie;
 class DREffectMovie;
 class DRSceneMovie;
@@ -38,6 +39,7 @@ class DRShoutMovie;
 class DRSplashMovie;
 class DRStickerViewer;
 class DRTextEdit;
+#include <QHash>
 #include <QMainWindow>
 #include <QMap>
 #include <QModelIndex>
@@ -232,6 +234,7 @@ public:
   // But the general idea is objection animation->pre animation->talking->idle
   void next_chatmessage(QStringList p_contents);
   void reset_viewport();
+  void display_chatmessage(QStringList p_contents);
   void preload_chatmessage(QStringList p_contents);
   void handle_chatmessage();
   void handle_chatmessage_2();
@@ -354,6 +357,12 @@ private:
 
   static const int MINIMUM_MESSAGE_SIZE = 15;
   static const int OPTIMAL_MESSAGE_SIZE = 26;
+  // number of queued messages whose sprites are decoded ahead of time
+  static const int CHATMESSAGE_LOOKAHEAD = 3;
+  // how long a message may hold back the queue, in milliseconds
+  static const int CHATMESSAGE_MAX_HOLD = 5000;
+  QQueue<QStringList> m_chatmessage_queue;
+  QTimer *m_chatmessage_queue_timer;
   QStringList m_pre_chatmessage;
   GameState m_game_state = GameState::Finished;
 
@@ -471,6 +480,8 @@ private:
   QMap<ViewportSprite, mk2::SpritePlayer *> m_viewport_viewer_map;
   QMap<ViewportSprite, mk2::SpriteReader::ptr> m_preloader_cache;
   QMap<ViewportSprite, mk2::SpriteReader::ptr> m_reader_cache;
+  // readers for the sprites of queued messages, by file name
+  QHash<QString, mk2::SpriteReader::ptr> m_lookahead_reader_cache;
 
   void map_viewers();
   void map_viewport_viewers();
@@ -481,6 +492,9 @@ private:
   void assign_readers_for_all_viewers();
   void swap_viewport_reader(DRMovie *viewer, ViewportSprite type);
   void cleanup_preload_readers();
+  void preload_queued_chatmessages();
+  QMap<ViewportSprite, QString> get_queued_sprite_files(const ICMessageData &message_data);
+  mk2::SpriteReader::ptr create_viewport_reader(ViewportSprite type, QString file_name);
 
   //Evidence
   AOImageDisplay *wEvidencePreviewImage = nullptr;
@@ -499,8 +513,7 @@ private:
   DRStickerViewer *ui_vp_clock = nullptr;
   QVector<AOTimer *> ui_timers;
 
-  DRTextEdit *ui_ic_chatlog = nullptr;
-  QList<DRChatRecord> m_ic_record_list;
+  DRChatLogView *ui_ic_chatlog = nullptr;
   QQueue<DRChatRecord> m_ic_record_queue;
   AOButton *ui_ic_chatlog_scroll_topdown = nullptr;
   AOButton *ui_ic_chatlog_scroll_bottomup = nullptr;
@@ -744,6 +757,7 @@ private slots:
 
   void on_loading_bar_delay_changed(int p_delay);
   void start_chatmessage();
+  void advance_chatmessage_queue();
 
   void start_chat_timer();
   void stop_chat_timer();
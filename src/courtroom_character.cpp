@@ -17,7 +17,6 @@
 #include <QListView>
 #include <QPixmap>
 #include <QUrl>
-#include "modules/debug/time_debugger.h"
 #include "modules/managers/character_manager.h"
 #include <QtConcurrent/QtConcurrent>
 
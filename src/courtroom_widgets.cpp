@@ -18,6 +18,7 @@
 #include "commondefs.h"
 #include "drcharactermovie.h"
 #include "drchatlog.h"
+#include "drchatlogview.h"
 #include "drtheme.h"
 #include "dreffectmovie.h"
 #include "drscenemovie.h"
@@ -50,7 +51,7 @@
 
 #include <modules/theme/widgets/dro_combo_box.h>
 #include <modules/theme/widgets/dro_line_edit.h>
-#include "modules/debug/time_debugger.h"
+#include "modules/debug/profiler.h"
 
 #include <modules/managers/evidence_manager.h>
 #include <modules/managers/localization_manager.h>
@@ -58,7 +59,7 @@
 
 void Courtroom::create_widgets()
 {
-  TimeDebugger::get().StartTimer("Theme Widgets");
+  DR_PROFILE_SCOPE("Theme Widgets");
   m_keepalive_timer = new QTimer(this);
   m_keepalive_timer->start(60000);
 
@@ -171,6 +172,9 @@ void Courtroom::create_widgets()
   m_loading_timer->setSingleShot(true);
   m_loading_timer->setInterval(ao_config->loading_bar_delay());
 
+  m_chatmessage_queue_timer = new QTimer(this);
+  m_chatmessage_queue_timer->setSingleShot(true);
+
   ui_iniswap_dropdown = new QComboBox(this);
   ui_iniswap_dropdown->setInsertPolicy(QComboBox::NoInsert);
   {
@@ -180,9 +184,7 @@ void Courtroom::create_widgets()
     l_view->setHorizontalScrollBarPolicy(Qt::ScrollBarPolicy::ScrollBarAsNeeded);
   }
 
-  ui_ic_chatlog = new DRTextEdit(this);
-  ui_ic_chatlog->setReadOnly(true);
-  ui_ic_chatlog->set_auto_align(false);
+  ui_ic_chatlog = new DRChatLogView(this);
   ui_ic_chatlog_scroll_topdown = ThemeManager::get().CreateWidgetButton(COURTROOM, "ic_chatlog_scroll_topdown", "ic_chatlog_scroll_topdown.png", "", this);
   ui_ic_chatlog_scroll_bottomup = ThemeManager::get().CreateWidgetButton(COURTROOM, "ic_chatlog_scroll_bottomup", "ic_chatlog_scroll_bottomup.png", "", this);
 
@@ -388,8 +390,6 @@ void Courtroom::create_widgets()
   construct_playerlist();
 
   construct_char_select();
-
-  TimeDebugger::get().EndTimer("Theme Widgets");
 }
 
 QComboBox *Courtroom::setupComboBoxWidget(const QStringList& items, QString name, QString cssHeader)
@@ -543,7 +543,9 @@ void Courtroom::connect_widgets()
   // performance
   connect(ao_config, SIGNAL(sprite_caching_toggled(int, bool)), this, SLOT(assign_readers_for_viewers(int, bool)));
   connect(ao_config, SIGNAL(caching_threshold_changed(int)), m_preloader_sync, SLOT(set_threshold(int)));
+  connect(ao_config, SIGNAL(play_through_sync_changed(bool)), m_preloader_sync, SLOT(set_play_through(bool)));
   connect(m_preloader_sync, SIGNAL(finished()), this, SLOT(start_chatmessage()));
+  connect(m_chatmessage_queue_timer, SIGNAL(timeout()), this, SLOT(advance_chatmessage_queue()));
   connect(ao_config, SIGNAL(loading_bar_delay_changed(int)), this, SLOT(on_loading_bar_delay_changed(int)));
   connect(m_loading_timer, SIGNAL(timeout()), ui_vp_loading, SLOT(show()));
 
@@ -980,16 +982,16 @@ void Courtroom::set_widgets()
 
   ui_background->move(0, 0);
   ui_background->resize(m_default_size);
-  TimeDebugger::get().CheckpointTimer("Courtroom Setup", "Set Resize");
+  DR_PROFILE_MARK("Set Resize");
   ui_background->set_theme_image(ao_app->current_theme->get_widget_image("courtroom", "courtroombackground.png", "courtroom"));
 
-  TimeDebugger::get().CheckpointTimer("Courtroom Setup", "Set Background");
+  DR_PROFILE_MARK("Set Background");
 
   ThemeManager::get().RefreshWidgetsButton();
-  TimeDebugger::get().CheckpointTimer("Courtroom Setup", "SetWidget-BUttons");
+  DR_PROFILE_MARK("SetWidget-Buttons");
   ThemeManager::get().RefreshWidgetsLineEdit();
   ThemeManager::get().RefreshWidgetsComboBox();
-  TimeDebugger::get().CheckpointTimer("Courtroom Setup", "SetWidget-ComboBox");
+  DR_PROFILE_MARK("SetWidget-ComboBox");
 
   setupWidgetElement(ui_viewport, "viewport");
   setupWidgetElement(wShoutsLayer, "viewport");
@@ -1004,7 +1006,7 @@ void Courtroom::set_widgets()
   ui_vp_showname_image->hide();
 
   setupWidgetElement(ui_vp_message, "message", "", Qt::NoTextInteraction);
-  TimeDebugger::get().CheckpointTimer("Courtroom Setup", "Setup Viewport Widgets");
+  DR_PROFILE_MARK("Setup Viewport Widgets");
 
   set_size_and_pos(ui_vp_chat_arrow, "chat_arrow", COURTROOM_DESIGN_INI, ao_app);
 
@@ -1123,7 +1125,7 @@ void Courtroom::set_widgets()
       ui_emote_preview->resize(l_emote_preview_size.width, l_emote_preview_size.height);
       ui_emote_preview_background->set_theme_image("emote_preview.png");
       ui_emote_preview_character->set_size(QSizeF(l_emote_preview_size.width, l_emote_preview_size.height));
-      TimeDebugger::get().CheckpointTimer("Courtroom Setup", "Emote Preview");
+      DR_PROFILE_MARK("Emote Preview");
     }
   }
 
@@ -1131,11 +1133,11 @@ void Courtroom::set_widgets()
   set_size_and_pos(ui_emote_dropdown, "emote_dropdown", COURTROOM_DESIGN_INI, ao_app);
   set_stylesheet(ui_emote_dropdown, "[EMOTE DROPDOWN]", COURTROOM_STYLESHEETS_CSS, ao_app);
 
-  TimeDebugger::get().CheckpointTimer("Courtroom Setup", "Emote Drowndown");
+  DR_PROFILE_MARK("Emote Dropdown");
 
   set_size_and_pos(ui_iniswap_dropdown, "iniswap_dropdown", COURTROOM_DESIGN_INI, ao_app);
   UpdateIniswapStylesheet();
-  TimeDebugger::get().CheckpointTimer("Courtroom Setup", "Iniswap Dropdown");
+  DR_PROFILE_MARK("Iniswap Dropdown");
 
   set_size_and_pos(ui_pos_dropdown, "pos_dropdown", COURTROOM_DESIGN_INI, ao_app);
   set_stylesheet(ui_pos_dropdown, "[POS DROPDOWN]", COURTROOM_STYLESHEETS_CSS, ao_app);
@@ -1150,7 +1152,7 @@ void Courtroom::set_widgets()
   }
   reset_shout_buttons();
 
-  TimeDebugger::get().CheckpointTimer("Courtroom Setup", "Shout Buttons");
+  DR_PROFILE_MARK("Shout Buttons");
 
 
   // courtroom_config.ini necessary + check for crash
@@ -1763,7 +1765,7 @@ void Courtroom::set_fonts()
   ui_vp_showname->setPlainText(ui_vp_showname->toPlainText());
   set_drtextedit_font(ui_vp_message, "message", COURTROOM_FONTS_INI, ao_app);
   ui_vp_message->setPlainText(ui_vp_message->toPlainText());
-  set_drtextedit_font(ui_ic_chatlog, "ic_chatlog", COURTROOM_FONTS_INI, ao_app);
+  set_drchatlogview_font(ui_ic_chatlog, "ic_chatlog", COURTROOM_FONTS_INI, ao_app);
 
   set_drtextedit_font(wEvidenceDescription, "evidence_description", COURTROOM_FONTS_INI, ao_app);
   wEvidenceDescription->setPlainText(wEvidenceDescription->toPlainText());
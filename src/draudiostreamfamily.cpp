@@ -5,12 +5,41 @@
 
 #include "draudioengine.h"
 
+#include <bass/bassopus.h>
+#include <modules/managers/memory_manager.h>
+
 #include <QDebug>
 
+namespace
+{
+int sample_memory_consumer()
+{
+  // samples are replayed at any time, so they are never evicted
+  static const int s_consumer = MemoryManager::get().RegisterConsumer("audio samples", MemoryManager::Priority::Active);
+  return s_consumer;
+}
+
+qint64 get_sample_size(HSAMPLE p_sample)
+{
+  BASS_SAMPLE l_info;
+  return BASS_SampleGetInfo(p_sample, &l_info) ? qint64(l_info.length) : 0;
+}
+} // namespace
+
 DRAudioStreamFamily::DRAudioStreamFamily(DRAudio::Family p_family)
     : m_family(p_family)
 {}
 
+DRAudioStreamFamily::~DRAudioStreamFamily()
+{
+  // families live until static destruction, when the memory budget may already be gone
+  for (const HSAMPLE i_sample : qAsConst(m_sample_map))
+  {
+    if (i_sample)
+      BASS_SampleFree(i_sample);
+  }
+}
+
 int32_t DRAudioStreamFamily::get_capacity() const
 {
   return m_capacity;
@@ -131,6 +160,113 @@ DRAudioStream::ptr DRAudioStreamFamily::play_stream(QString p_filename)
   return l_stream;
 }
 
+bool DRAudioStreamFamily::load_sample(QString p_filename)
+{
+  if (p_filename.isEmpty())
+    return false;
+
+  if (auto it = m_sample_map.constFind(p_filename); it != m_sample_map.cend())
+    return it.value() != 0;
+
+  if (m_engine == nullptr)
+  {
+    m_engine = new DRAudioEngine(this);
+    connect(m_engine, &DRAudioEngine::current_device_changed, this, &DRAudioStreamFamily::update_sample_device);
+  }
+
+  // failures are remembered too, so that a broken file is not reloaded on every use; callers play it as a stream
+  // instead
+  const HSAMPLE l_sample = create_sample(p_filename);
+  m_sample_map.insert(p_filename, l_sample);
+  if (!l_sample)
+  {
+    qWarning() << QString("error: failed to load sample: %1 (file: \"%2\")").arg(DRAudio::get_last_bass_error(), p_filename);
+    return false;
+  }
+
+  // the sample is already in memory; lower priority consumers give back what no longer fits
+  MemoryManager::get().AddUsage(sample_memory_consumer(), get_sample_size(l_sample));
+  MemoryManager::get().EnsureHeadroom(0, MemoryManager::Priority::Active);
+  qInfo() << "Loaded sample" << p_filename;
+  return true;
+}
+
+bool DRAudioStreamFamily::play_sample(QString p_filename)
+{
+  if (!load_sample(p_filename))
+    return false;
+
+  // the sample overrides its oldest channel once the pool is exhausted
+  const HCHANNEL l_channel = BASS_SampleGetChannel(m_sample_map.value(p_filename), FALSE);
+  if (!l_channel)
+  {
+    qWarning() << QString("error: failed to get sample channel: %1 (file: \"%2\")").arg(DRAudio::get_last_bass_error(), p_filename);
+    return false;
+  }
+
+  BASS_ChannelSetAttribute(l_channel, BASS_ATTRIB_VOL, calculate_volume() * 0.01f);
+  return BASS_ChannelPlay(l_channel, TRUE);
+}
+
+void DRAudioStreamFamily::clear_samples()
+{
+  for (const HSAMPLE i_sample : qAsConst(m_sample_map))
+  {
+    if (i_sample)
+      free_sample(i_sample);
+  }
+  m_sample_map.clear();
+}
+
+void DRAudioStreamFamily::free_sample(HSAMPLE p_sample)
+{
+  MemoryManager::get().AddUsage(sample_memory_consumer(), -get_sample_size(p_sample));
+  BASS_SampleFree(p_sample);
+}
+
+HSAMPLE DRAudioStreamFamily::create_sample(QString p_filename)
+{
+  const DWORD l_max_channels = qMax(1, m_capacity);
+  if (!p_filename.endsWith("opus", Qt::CaseInsensitive))
+  {
+    const HSAMPLE l_sample = BASS_SampleLoad(FALSE, p_filename.utf16(), 0, 0, l_max_channels, BASS_UNICODE | BASS_SAMPLE_OVER_POS);
+    if (l_sample)
+      return l_sample;
+  }
+
+  // formats only available as streams are decoded into a sample by hand
+  const HSTREAM l_decoder = p_filename.endsWith("opus", Qt::CaseInsensitive)
+                                ? BASS_OPUS_StreamCreateFile(FALSE, p_filename.utf16(), 0, 0, BASS_UNICODE | BASS_STREAM_DECODE)
+                                : BASS_StreamCreateFile(FALSE, p_filename.utf16(), 0, 0, BASS_UNICODE | BASS_STREAM_DECODE);
+  if (!l_decoder)
+    return 0;
+
+  BASS_CHANNELINFO l_info;
+  BASS_ChannelGetInfo(l_decoder, &l_info);
+
+  QByteArray l_data;
+  char l_buffer[16384];
+  for (;;)
+  {
+    const DWORD l_read = BASS_ChannelGetData(l_decoder, l_buffer, sizeof(l_buffer));
+    if (l_read == DWORD(-1) || l_read == 0)
+      break;
+    l_data.append(l_buffer, l_read);
+  }
+  BASS_StreamFree(l_decoder);
+
+  if (l_data.isEmpty())
+    return 0;
+
+  const HSAMPLE l_sample = BASS_SampleCreate(l_data.size(), l_info.freq, l_info.chans, l_max_channels, BASS_SAMPLE_OVER_POS | (l_info.flags & BASS_SAMPLE_FLOAT));
+  if (l_sample && !BASS_SampleSetData(l_sample, l_data.constData()))
+  {
+    BASS_SampleFree(l_sample);
+    return 0;
+  }
+  return l_sample;
+}
+
 DRAudioStreamFamily::stream_list DRAudioStreamFamily::get_stream_list() const
 {
   return m_stream_list;
@@ -177,6 +313,19 @@ void DRAudioStreamFamily::update_volume()
   const float volume = calculate_volume();
   for (auto &stream : m_stream_list)
     stream->set_volume(volume);
+
+  for (const HSAMPLE i_sample : qAsConst(m_sample_map))
+  {
+    if (!i_sample)
+      continue;
+    const DWORD l_count = BASS_SampleGetChannels(i_sample, nullptr);
+    if (l_count == DWORD(-1) || l_count == 0)
+      continue;
+    QVector<HCHANNEL> l_channel_list(l_count);
+    const DWORD l_filled = BASS_SampleGetChannels(i_sample, l_channel_list.data());
+    for (DWORD i = 0; i < l_filled && i < l_count; ++i)
+      BASS_ChannelSetAttribute(l_channel_list.at(i), BASS_ATTRIB_VOL, volume * 0.01f);
+  }
 }
 
 void DRAudioStreamFamily::on_stream_finished()
@@ -199,3 +348,24 @@ void DRAudioStreamFamily::on_stream_finished()
   }
   m_stream_list = std::move(new_stream_list);
 }
+
+void DRAudioStreamFamily::update_sample_device(DRAudioDevice p_device)
+{
+  // samples that fail to move, or failed to load before, are retried on their next use
+  for (auto it = m_sample_map.begin(); it != m_sample_map.end();)
+  {
+    const HSAMPLE l_sample = it.value();
+    if (l_sample && (BASS_ChannelGetDevice(l_sample) == p_device.get_id() || BASS_ChannelSetDevice(l_sample, p_device.get_id())))
+    {
+      ++it;
+      continue;
+    }
+
+    if (l_sample)
+    {
+      qDebug() << "error: failed to switch sample device;" << DRAudio::get_last_bass_error() << p_device.get_name();
+      free_sample(l_sample);
+    }
+    it = m_sample_map.erase(it);
+  }
+}
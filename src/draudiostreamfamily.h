@@ -3,6 +3,7 @@
 #include "draudiostream.h"
 
 #include <QFlags>
+#include <QHash>
 #include <QSharedPointer>
 #include <QVector>
 
@@ -17,10 +18,18 @@ public:
   using ptr = QSharedPointer<DRAudioStreamFamily>;
   using stream_list = QVector<DRAudioStream::ptr>;
 
+  ~DRAudioStreamFamily();
+
   DRAudioStream::ptr create_stream(QString p_file);
   DRAudioStream::ptr create_url_stream(QString t_url);
   DRAudioStream::ptr play_stream(QString p_file);
 
+  // samples are decoded once and replayed from memory on a channel pool
+  // sized by the family capacity
+  bool load_sample(QString p_file);
+  bool play_sample(QString p_file);
+  void clear_samples();
+
   // get
   stream_list get_stream_list() const;
   int32_t get_volume() const;
@@ -54,9 +63,15 @@ private:
   int32_t m_capacity = 0;
   DRAudio::Options m_options;
   stream_list m_stream_list;
+  // a null handle marks a file that failed to load
+  QHash<QString, HSAMPLE> m_sample_map;
+  DRAudioEngine *m_engine = nullptr;
 
   DRAudioStreamFamily(DRAudio::Family p_family);
 
+  HSAMPLE create_sample(QString p_file);
+  void free_sample(HSAMPLE p_sample);
+
   float calculate_volume();
 
   void update_capacity();
@@ -65,4 +80,5 @@ private:
 
 private slots:
   void on_stream_finished();
+  void update_sample_device(DRAudioDevice p_device);
 };
@@ -0,0 +1,188 @@
+#include "drchatlogdelegate.h"
+
+#include "datatypes.h"
+#include "drchatrecordmodel.h"
+
+#include <QAbstractItemView>
+#include <QAbstractTextDocumentLayout>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtMath>
+
+DRChatLogDelegate::DRChatLogDelegate(QAbstractItemView *p_view)
+    : QStyledItemDelegate(p_view)
+    , m_view(p_view)
+{}
+
+void DRChatLogDelegate::paint(QPainter *p_painter, const QStyleOptionViewItem &p_option, const QModelIndex &p_index) const
+{
+  const DRChatRecordModel *l_model = qobject_cast<const DRChatRecordModel *>(p_index.model());
+  if (l_model == nullptr)
+    return;
+
+  p_painter->save();
+  if (p_option.state & QStyle::State_Selected)
+    p_painter->fillRect(p_option.rect, p_option.palette.highlight());
+
+  QTextDocument l_document;
+  layout_record(l_document, l_model->get_record(p_index.row()), p_option.rect.width());
+
+  p_painter->translate(p_option.rect.topLeft());
+  p_painter->setClipRect(QRect(QPoint(0, 0), p_option.rect.size()));
+  QAbstractTextDocumentLayout::PaintContext l_context;
+  l_context.palette = p_option.palette;
+  l_document.documentLayout()->draw(p_painter, l_context);
+  p_painter->restore();
+}
+
+QSize DRChatLogDelegate::sizeHint(const QStyleOptionViewItem &p_option, const QModelIndex &p_index) const
+{
+  Q_UNUSED(p_option);
+
+  const DRChatRecordModel *l_model = qobject_cast<const DRChatRecordModel *>(p_index.model());
+  if (l_model == nullptr)
+    return QSize();
+
+  const int l_width = get_text_width();
+  if (m_cached_width != l_width)
+  {
+    m_height_cache.clear();
+    m_cached_width = l_width;
+  }
+
+  const qint64 l_record_id = l_model->get_record_id(p_index.row());
+  auto l_height = m_height_cache.constFind(l_record_id);
+  if (l_height == m_height_cache.constEnd())
+  {
+    QTextDocument l_document;
+    layout_record(l_document, l_model->get_record(p_index.row()), l_width);
+    const int l_record_height = qCeil(l_document.size().height()) + get_record_spacing();
+    l_height = m_height_cache.insert(l_record_id, l_record_height);
+  }
+  return QSize(l_width, l_height.value());
+}
+
+void DRChatLogDelegate::set_name_format(QTextCharFormat p_format)
+{
+  m_name_format = p_format;
+}
+
+void DRChatLogDelegate::set_selfname_format(QTextCharFormat p_format)
+{
+  m_selfname_format = p_format;
+}
+
+void DRChatLogDelegate::set_message_format(QTextCharFormat p_format)
+{
+  m_message_format = p_format;
+}
+
+void DRChatLogDelegate::set_system_format(QTextCharFormat p_format)
+{
+  m_system_format = p_format;
+}
+
+void DRChatLogDelegate::set_display_timestamp(bool p_enabled)
+{
+  m_display_timestamp = p_enabled;
+}
+
+void DRChatLogDelegate::set_display_client_id(bool p_enabled)
+{
+  m_display_client_id = p_enabled;
+}
+
+void DRChatLogDelegate::set_display_self_highlight(bool p_enabled)
+{
+  m_display_self_highlight = p_enabled;
+}
+
+void DRChatLogDelegate::set_use_newline(bool p_enabled)
+{
+  m_use_newline = p_enabled;
+}
+
+void DRChatLogDelegate::set_horizontal_alignment(Qt::Alignment p_alignment)
+{
+  m_horizontal_alignment = p_alignment & Qt::AlignHorizontal_Mask;
+}
+
+// outlines do not change the layout, so cached heights stay valid
+void DRChatLogDelegate::set_outline(bool p_enabled)
+{
+  m_outline = p_enabled;
+}
+
+void DRChatLogDelegate::clear_cache()
+{
+  m_height_cache.clear();
+  m_cached_width = -1;
+}
+
+void DRChatLogDelegate::remove_cached_records(qint64 p_first_record_id, qint64 p_end_record_id)
+{
+  for (qint64 i = p_first_record_id; i < p_end_record_id; ++i)
+    m_height_cache.remove(i);
+}
+
+int DRChatLogDelegate::get_text_width() const
+{
+  return qMax(1, m_view->viewport()->width());
+}
+
+int DRChatLogDelegate::get_record_spacing() const
+{
+  // records used to be separated by an empty line in newline mode
+  if (!m_use_newline)
+    return 0;
+  return QFontMetrics(m_message_format.font()).lineSpacing();
+}
+
+void DRChatLogDelegate::layout_record(QTextDocument &p_document, const DRChatRecord &p_record, int p_width) const
+{
+  p_document.setDocumentMargin(0);
+  p_document.setDefaultFont(m_message_format.font());
+  QTextOption l_option = p_document.defaultTextOption();
+  l_option.setAlignment(m_horizontal_alignment);
+  l_option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+  p_document.setDefaultTextOption(l_option);
+  p_document.setTextWidth(p_width);
+
+  QTextCursor l_cursor(&p_document);
+
+  // same outline as DRTextEdit draws
+  const auto l_outlined = [this](QTextCharFormat p_format) {
+    if (m_outline)
+      p_format.setTextOutline(QPen(Qt::black, 1));
+    return p_format;
+  };
+
+  // self-highlight check
+  const QTextCharFormat l_name_format = l_outlined((p_record.is_self() && m_display_self_highlight) ? m_selfname_format : m_name_format);
+
+  if (m_display_timestamp)
+    l_cursor.insertText(QString("[%1] ").arg(p_record.get_timestamp().toString("hh:mm")), l_name_format);
+
+  if (p_record.is_system())
+  {
+    l_cursor.insertText(p_record.get_message(), l_outlined(m_system_format));
+    return;
+  }
+
+  QString l_separator;
+  if (m_use_newline)
+    l_separator = QString(QChar::LineFeed);
+  else if (!p_record.is_music())
+    l_separator = ": ";
+  else
+    l_separator = " ";
+
+  const int l_client_id = p_record.get_client_id();
+  if (l_client_id != NoClientId && m_display_client_id)
+    l_cursor.insertText(QString::number(l_client_id) + " | ", l_name_format);
+
+  l_cursor.insertText(p_record.get_name() + l_separator, l_name_format);
+  l_cursor.insertText(p_record.get_message(), l_outlined(m_message_format));
+}
@@ -0,0 +1,66 @@
+#ifndef DRCHATLOGDELEGATE_H
+#define DRCHATLOGDELEGATE_H
+
+#include <QHash>
+#include <QStyledItemDelegate>
+#include <QTextCharFormat>
+
+class DRChatRecord;
+
+class QAbstractItemView;
+class QTextDocument;
+
+/*!
+ * Lays out the records of a DRChatRecordModel.
+ *
+ * Only the rows being painted are turned into text documents; the height of
+ * every row is cached by record id until the view width or the formats change.
+ */
+class DRChatLogDelegate : public QStyledItemDelegate
+{
+  Q_OBJECT
+
+public:
+  DRChatLogDelegate(QAbstractItemView *view);
+
+  void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+  QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+  void set_name_format(QTextCharFormat format);
+  void set_selfname_format(QTextCharFormat format);
+  void set_message_format(QTextCharFormat format);
+  void set_system_format(QTextCharFormat format);
+  void set_display_timestamp(bool enabled);
+  void set_display_client_id(bool enabled);
+  void set_display_self_highlight(bool enabled);
+  void set_use_newline(bool enabled);
+  void set_horizontal_alignment(Qt::Alignment alignment);
+  void set_outline(bool enabled);
+
+public slots:
+  void clear_cache();
+  void remove_cached_records(qint64 first_record_id, qint64 end_record_id);
+
+private:
+  QAbstractItemView *m_view = nullptr;
+  QTextCharFormat m_name_format;
+  QTextCharFormat m_selfname_format;
+  QTextCharFormat m_message_format;
+  QTextCharFormat m_system_format;
+  bool m_display_timestamp = false;
+  bool m_display_client_id = false;
+  bool m_display_self_highlight = false;
+  bool m_use_newline = false;
+  Qt::Alignment m_horizontal_alignment = Qt::AlignLeft;
+  bool m_outline = false;
+
+  // record id -> row height, valid for m_cached_width only
+  mutable QHash<qint64, int> m_height_cache;
+  mutable int m_cached_width = -1;
+
+  int get_text_width() const;
+  int get_record_spacing() const;
+  void layout_record(QTextDocument &document, const DRChatRecord &record, int width) const;
+};
+
+#endif // DRCHATLOGDELEGATE_H
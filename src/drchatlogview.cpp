@@ -0,0 +1,83 @@
+#include "drchatlogview.h"
+
+#include "drchatlogdelegate.h"
+#include "drchatrecordmodel.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+
+#include <algorithm>
+
+DRChatLogView::DRChatLogView(QWidget *parent)
+    : QListView(parent)
+    , m_record_model(new DRChatRecordModel(this))
+    , m_delegate(new DRChatLogDelegate(this))
+{
+  setModel(m_record_model);
+  setItemDelegate(m_delegate);
+  setEditTriggers(QAbstractItemView::NoEditTriggers);
+  setSelectionMode(QAbstractItemView::ExtendedSelection);
+  setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+  setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  setResizeMode(QListView::Adjust);
+  // rows are laid out in batches so that a long log never stalls the event loop
+  setLayoutMode(QListView::Batched);
+  setWordWrap(true);
+
+  connect(m_record_model, &DRChatRecordModel::records_removed, m_delegate, &DRChatLogDelegate::remove_cached_records);
+  connect(this, &DRChatLogView::text_alignment_changed, this, &DRChatLogView::reset_layout);
+}
+
+DRChatRecordModel *DRChatLogView::get_record_model() const
+{
+  return m_record_model;
+}
+
+DRChatLogDelegate *DRChatLogView::get_delegate() const
+{
+  return m_delegate;
+}
+
+Qt::Alignment DRChatLogView::get_text_alignment() const
+{
+  return m_text_align;
+}
+
+void DRChatLogView::set_text_alignment(Qt::Alignment p_align)
+{
+  if (m_text_align == p_align)
+    return;
+  m_text_align = p_align;
+  m_delegate->set_horizontal_alignment(m_text_align);
+  Q_EMIT text_alignment_changed(m_text_align);
+}
+
+void DRChatLogView::set_outline(bool p_enabled)
+{
+  m_delegate->set_outline(p_enabled);
+  viewport()->update();
+}
+
+void DRChatLogView::reset_layout()
+{
+  m_delegate->clear_cache();
+  scheduleDelayedItemsLayout();
+  viewport()->update();
+}
+
+void DRChatLogView::keyPressEvent(QKeyEvent *event)
+{
+  if (!event->matches(QKeySequence::Copy))
+  {
+    QListView::keyPressEvent(event);
+    return;
+  }
+
+  QModelIndexList l_index_list = selectionModel()->selectedRows();
+  std::sort(l_index_list.begin(), l_index_list.end());
+  QStringList l_line_list;
+  for (const QModelIndex &i_index : qAsConst(l_index_list))
+    l_line_list.append(i_index.data(Qt::DisplayRole).toString());
+  QApplication::clipboard()->setText(l_line_list.join(QChar::LineFeed));
+}
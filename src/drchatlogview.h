@@ -0,0 +1,39 @@
+#ifndef DRCHATLOGVIEW_H
+#define DRCHATLOGVIEW_H
+
+#include <QListView>
+
+class DRChatLogDelegate;
+class DRChatRecordModel;
+
+class DRChatLogView : public QListView
+{
+  Q_OBJECT
+
+  Q_PROPERTY(Qt::Alignment text_alignment READ get_text_alignment WRITE set_text_alignment NOTIFY text_alignment_changed)
+
+public:
+  DRChatLogView(QWidget *parent = nullptr);
+
+  DRChatRecordModel *get_record_model() const;
+  DRChatLogDelegate *get_delegate() const;
+  Qt::Alignment get_text_alignment() const;
+
+public slots:
+  void set_text_alignment(Qt::Alignment alignment);
+  void set_outline(bool enabled);
+  void reset_layout();
+
+signals:
+  void text_alignment_changed(Qt::Alignment);
+
+protected:
+  void keyPressEvent(QKeyEvent *event) override;
+
+private:
+  DRChatRecordModel *m_record_model = nullptr;
+  DRChatLogDelegate *m_delegate = nullptr;
+  Qt::Alignment m_text_align = Qt::AlignTop | Qt::AlignLeft;
+};
+
+#endif // DRCHATLOGVIEW_H
@@ -0,0 +1,188 @@
+#include "drchatrecordmodel.h"
+
+DRChatRecordModel::DRChatRecordModel(QObject *parent)
+    : QAbstractListModel(parent)
+{}
+
+int DRChatRecordModel::rowCount(const QModelIndex &parent) const
+{
+  if (parent.isValid())
+    return 0;
+  return m_visible_id_list.length();
+}
+
+QVariant DRChatRecordModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid() || index.row() >= rowCount())
+    return QVariant();
+
+  switch (role)
+  {
+  case Qt::DisplayRole:
+  {
+    const DRChatRecord &l_record = get_record(index.row());
+    if (l_record.is_system())
+      return l_record.get_message();
+    return l_record.get_name() + (l_record.is_music() ? " " : ": ") + l_record.get_message();
+  }
+  case RecordIdRole:
+    return get_record_id(index.row());
+  default:
+    return QVariant();
+  }
+}
+
+const DRChatRecord &DRChatRecordModel::get_record(int p_row) const
+{
+  return m_record_list.at(int(get_record_id(p_row) - m_first_record_id));
+}
+
+qint64 DRChatRecordModel::get_record_id(int p_row) const
+{
+  return m_visible_id_list.at(get_visible_index(p_row));
+}
+
+qint64 DRChatRecordModel::get_first_record_id() const
+{
+  return m_first_record_id;
+}
+
+int DRChatRecordModel::get_record_count() const
+{
+  return m_record_list.length();
+}
+
+int DRChatRecordModel::get_max_record_count() const
+{
+  return m_max_record_count;
+}
+
+bool DRChatRecordModel::is_reversed() const
+{
+  return m_reversed;
+}
+
+bool DRChatRecordModel::is_display_empty_messages() const
+{
+  return m_display_empty_messages;
+}
+
+bool DRChatRecordModel::is_display_music_switch() const
+{
+  return m_display_music_switch;
+}
+
+void DRChatRecordModel::append_record(DRChatRecord p_record)
+{
+  const qint64 l_record_id = m_first_record_id + m_record_list.length();
+  const bool l_is_visible = is_visible(p_record);
+  m_record_list.append(std::move(p_record));
+
+  if (l_is_visible)
+  {
+    const int l_row = m_reversed ? 0 : m_visible_id_list.length();
+    beginInsertRows(QModelIndex(), l_row, l_row);
+    m_visible_id_list.append(l_record_id);
+    endInsertRows();
+  }
+
+  trim_records();
+}
+
+void DRChatRecordModel::clear()
+{
+  if (m_record_list.isEmpty())
+    return;
+
+  const qint64 l_first_record_id = m_first_record_id;
+  beginResetModel();
+  m_first_record_id += m_record_list.length();
+  m_record_list.clear();
+  m_visible_id_list.clear();
+  endResetModel();
+  Q_EMIT records_removed(l_first_record_id, m_first_record_id);
+}
+
+void DRChatRecordModel::set_max_record_count(int p_count)
+{
+  p_count = qMax(1, p_count);
+  if (m_max_record_count == p_count)
+    return;
+  m_max_record_count = p_count;
+  trim_records();
+}
+
+void DRChatRecordModel::set_reversed(bool p_enabled)
+{
+  if (m_reversed == p_enabled)
+    return;
+  beginResetModel();
+  m_reversed = p_enabled;
+  endResetModel();
+}
+
+void DRChatRecordModel::set_display_empty_messages(bool p_enabled)
+{
+  if (m_display_empty_messages == p_enabled)
+    return;
+  m_display_empty_messages = p_enabled;
+  rebuild_visible_list();
+}
+
+void DRChatRecordModel::set_display_music_switch(bool p_enabled)
+{
+  if (m_display_music_switch == p_enabled)
+    return;
+  m_display_music_switch = p_enabled;
+  rebuild_visible_list();
+}
+
+bool DRChatRecordModel::is_visible(const DRChatRecord &p_record) const
+{
+  if (!m_display_empty_messages && p_record.get_message().trimmed().isEmpty())
+    return false;
+  if (!m_display_music_switch && p_record.is_music())
+    return false;
+  return true;
+}
+
+int DRChatRecordModel::get_visible_index(int p_row) const
+{
+  return m_reversed ? m_visible_id_list.length() - 1 - p_row : p_row;
+}
+
+void DRChatRecordModel::rebuild_visible_list()
+{
+  beginResetModel();
+  m_visible_id_list.clear();
+  for (int i = 0; i < m_record_list.length(); ++i)
+  {
+    if (is_visible(m_record_list.at(i)))
+      m_visible_id_list.append(m_first_record_id + i);
+  }
+  endResetModel();
+}
+
+void DRChatRecordModel::trim_records()
+{
+  const int l_remove_count = m_record_list.length() - m_max_record_count;
+  if (l_remove_count <= 0)
+    return;
+
+  const qint64 l_first_record_id = m_first_record_id;
+  m_first_record_id += l_remove_count;
+  m_record_list.erase(m_record_list.begin(), m_record_list.begin() + l_remove_count);
+
+  int l_visible_remove_count = 0;
+  while (l_visible_remove_count < m_visible_id_list.length() && m_visible_id_list.at(l_visible_remove_count) < m_first_record_id)
+    ++l_visible_remove_count;
+
+  if (l_visible_remove_count > 0)
+  {
+    const int l_first_row = m_reversed ? m_visible_id_list.length() - l_visible_remove_count : 0;
+    beginRemoveRows(QModelIndex(), l_first_row, l_first_row + l_visible_remove_count - 1);
+    m_visible_id_list.erase(m_visible_id_list.begin(), m_visible_id_list.begin() + l_visible_remove_count);
+    endRemoveRows();
+  }
+  Q_EMIT records_removed(l_first_record_id, m_first_record_id);
+}
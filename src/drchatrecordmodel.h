@@ -0,0 +1,71 @@
+#ifndef DRCHATRECORDMODEL_H
+#define DRCHATRECORDMODEL_H
+
+#include "datatypes.h"
+
+#include <QAbstractListModel>
+#include <QList>
+
+/*!
+ * Store of the IC log records.
+ *
+ * Every record gets an increasing id that never changes, so views can cache
+ * per-record data. Filtering and orientation only change which rows are
+ * exposed; the records themselves are never rebuilt.
+ */
+class DRChatRecordModel : public QAbstractListModel
+{
+  Q_OBJECT
+
+public:
+  enum Role
+  {
+    RecordIdRole = Qt::UserRole + 1,
+  };
+
+  DRChatRecordModel(QObject *parent = nullptr);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+  const DRChatRecord &get_record(int row) const;
+  qint64 get_record_id(int row) const;
+  qint64 get_first_record_id() const;
+  int get_record_count() const;
+
+  int get_max_record_count() const;
+  bool is_reversed() const;
+  bool is_display_empty_messages() const;
+  bool is_display_music_switch() const;
+
+public slots:
+  void append_record(DRChatRecord record);
+  void clear();
+
+  void set_max_record_count(int count);
+  void set_reversed(bool enabled);
+  void set_display_empty_messages(bool enabled);
+  void set_display_music_switch(bool enabled);
+
+signals:
+  // records from first_record_id up to, but excluding, end_record_id are gone
+  void records_removed(qint64 first_record_id, qint64 end_record_id);
+
+private:
+  QList<DRChatRecord> m_record_list;
+  // id of the first stored record
+  qint64 m_first_record_id = 0;
+  // ids of the records that pass the filters, oldest first
+  QList<qint64> m_visible_id_list;
+  int m_max_record_count = 200;
+  bool m_reversed = false;
+  bool m_display_empty_messages = true;
+  bool m_display_music_switch = true;
+
+  bool is_visible(const DRChatRecord &record) const;
+  int get_visible_index(int row) const;
+  void rebuild_visible_list();
+  void trim_records();
+};
+
+#endif // DRCHATRECORDMODEL_H
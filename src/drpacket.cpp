@@ -12,8 +12,15 @@ QString DRPacket::decode(QString p_data)
   return p_data.replace("<num>", "#").replace("<percent>", "%").replace("<dollar>", "$").replace("<and>", "&");
 }
 
+QString DRPacket::decode(const QByteArray &p_raw_data)
+{
+  // every escape sequence starts with '<'; most fields have none
+  const QString l_data = QString::fromUtf8(p_raw_data);
+  return p_raw_data.contains('<') ? decode(l_data) : l_data;
+}
+
 DRPacket::DRPacket(QString p_header)
-    : DRPacket(p_header, {})
+    : DRPacket(p_header, QStringList{})
 {}
 
 DRPacket::DRPacket(QString p_header, QStringList p_content)
@@ -22,6 +29,14 @@ DRPacket::DRPacket(QString p_header, QStringList p_content)
   m_content = p_content;
 }
 
+DRPacket::DRPacket(QString p_header, QByteArray p_raw_content, QVector<QPair<int, int>> p_field_list)
+{
+  m_header = p_header;
+  m_content_decoded = false;
+  m_raw_content = p_raw_content;
+  m_field_list = p_field_list;
+}
+
 const QString &DRPacket::get_header() const
 {
   return m_header;
@@ -29,13 +44,46 @@ const QString &DRPacket::get_header() const
 
 const QStringList &DRPacket::get_content() const
 {
+  if (!m_content_decoded)
+  {
+    m_content.clear();
+    m_content.reserve(m_field_list.length());
+    for (int i = 0; i < m_field_list.length(); ++i)
+      m_content.append(get_content_at(i));
+    m_content_decoded = true;
+  }
   return m_content;
 }
 
+int DRPacket::get_content_size() const
+{
+  return m_content_decoded ? m_content.length() : m_field_list.length();
+}
+
+QString DRPacket::get_content_at(int p_index) const
+{
+  if (m_content_decoded)
+    return m_content.value(p_index);
+  if (p_index < 0 || p_index >= m_field_list.length())
+    return QString{};
+  const QPair<int, int> &l_field = m_field_list.at(p_index);
+  return decode(QByteArray::fromRawData(m_raw_content.constData() + l_field.first, l_field.second));
+}
+
 QString DRPacket::to_string(const bool p_encode) const
 {
+  // received packets are still in their encoded form
+  if (p_encode && !m_content_decoded)
+  {
+    if (m_field_list.isEmpty())
+      return m_header + "#%";
+    const int l_begin = m_field_list.first().first;
+    const int l_end = m_field_list.last().first + m_field_list.last().second;
+    return m_header + "#" + QString::fromUtf8(m_raw_content.constData() + l_begin, l_end - l_begin) + "#%";
+  }
+
   QString r_data;
-  for (const QString &i_value : qAsConst(m_content))
+  for (const QString &i_value : qAsConst(get_content()))
     r_data += (p_encode ? encode(i_value) : i_value) + "#";
   return m_header + "#" + r_data + "%";
 }
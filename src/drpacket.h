@@ -1,22 +1,34 @@
 #pragma once
 
+#include <QByteArray>
+#include <QPair>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
 class DRPacket
 {
 public:
   static QString encode(QString data);
   static QString decode(QString data);
+  static QString decode(const QByteArray &raw_data);
 
   DRPacket(QString header);
   DRPacket(QString header, QStringList content);
+  // fields are offsets into the raw content, which may be a whole receive
+  // buffer shared with other packets; they are decoded when first read
+  DRPacket(QString header, QByteArray raw_content, QVector<QPair<int, int>> field_list);
 
   const QString &get_header() const;
   const QStringList &get_content() const;
+  int get_content_size() const;
+  QString get_content_at(int index) const;
   QString to_string(const bool encode = false) const;
 
 private:
   QString m_header;
-  QStringList m_content;
+  mutable QStringList m_content;
+  mutable bool m_content_decoded = true;
+  QByteArray m_raw_content;
+  QVector<QPair<int, int>> m_field_list;
 };
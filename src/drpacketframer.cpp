@@ -0,0 +1,103 @@
+#include "drpacketframer.h"
+
+#include <QElapsedTimer>
+
+void DRPacketFramer::append(const QByteArray &p_data)
+{
+  if (p_data.isEmpty())
+    return;
+
+  QElapsedTimer l_timer;
+  l_timer.start();
+
+  // drop the packets framed by a previous read; only the pending bytes are
+  // copied, and they are not scanned again. framed packets keep sharing the
+  // old buffer, so it is never modified in place
+  if (m_packet_pos > 0)
+  {
+    m_buffer = m_buffer.mid(m_packet_pos);
+    m_scan_pos -= m_packet_pos;
+    if (m_header_end != -1)
+      m_header_end -= m_packet_pos;
+    for (QPair<int, int> &i_field : m_field_list)
+      i_field.first -= m_packet_pos;
+    m_packet_pos = 0;
+  }
+
+  m_buffer.append(p_data);
+  m_statistics.received_bytes += p_data.size();
+  _p_scan();
+
+  m_statistics.elapsed_nsecs += l_timer.nsecsElapsed();
+}
+
+QVector<DRPacket> DRPacketFramer::take_packets()
+{
+  return std::move(m_packet_list);
+}
+
+void DRPacketFramer::clear()
+{
+  m_buffer.clear();
+  m_packet_pos = 0;
+  m_scan_pos = 0;
+  m_header_end = -1;
+  m_field_list.clear();
+  m_packet_list.clear();
+}
+
+DRPacketFramer::Statistics DRPacketFramer::get_statistics() const
+{
+  return m_statistics;
+}
+
+void DRPacketFramer::reset_statistics()
+{
+  m_statistics = Statistics{};
+}
+
+void DRPacketFramer::_p_scan()
+{
+  const char *l_data = m_buffer.constData();
+  const int l_size = m_buffer.size();
+  for (; m_scan_pos < l_size; ++m_scan_pos)
+  {
+    if (l_data[m_scan_pos] != '#')
+      continue;
+
+    // a trailing separator may still turn out to be a terminator
+    if (m_scan_pos + 1 == l_size)
+      break;
+
+    if (l_data[m_scan_pos + 1] != '%')
+    {
+      _p_add_field(m_scan_pos);
+      continue;
+    }
+
+    // packet terminator
+    _p_add_field(m_scan_pos);
+    const int l_header_end = m_header_end;
+    const QString l_header = QString::fromUtf8(l_data + m_packet_pos, l_header_end - m_packet_pos);
+    // the packet shares the receive buffer, its fields are offsets into it
+    m_packet_list.append(DRPacket(l_header, m_buffer, m_field_list));
+    ++m_statistics.framed_packets;
+
+    m_scan_pos += 1;
+    m_packet_pos = m_scan_pos + 1;
+    m_header_end = -1;
+    m_field_list.clear();
+  }
+}
+
+void DRPacketFramer::_p_add_field(int p_end)
+{
+  if (m_header_end == -1)
+  {
+    m_header_end = p_end;
+    return;
+  }
+
+  const int l_begin = m_field_list.isEmpty() ? m_header_end + 1 : m_field_list.last().first + m_field_list.last().second + 1;
+  m_field_list.append({l_begin, p_end - l_begin});
+}
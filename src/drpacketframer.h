@@ -0,0 +1,44 @@
+#pragma once
+
+#include "drpacket.h"
+
+#include <QByteArray>
+#include <QVector>
+
+/*!
+ * Splits the raw byte stream of a server connection into packets.
+ *
+ * Bytes are scanned exactly once: the scan position is kept between reads so
+ * that a partial packet is never examined again when more data arrives.
+ */
+class DRPacketFramer
+{
+public:
+  struct Statistics
+  {
+    qint64 received_bytes = 0;
+    qint64 framed_packets = 0;
+    qint64 elapsed_nsecs = 0;
+  };
+
+  void append(const QByteArray &data);
+  QVector<DRPacket> take_packets();
+  void clear();
+
+  Statistics get_statistics() const;
+  void reset_statistics();
+
+private:
+  QByteArray m_buffer;
+  // start of the packet being framed
+  int m_packet_pos = 0;
+  // everything before this position has been examined already
+  int m_scan_pos = 0;
+  int m_header_end = -1;
+  QVector<QPair<int, int>> m_field_list;
+  QVector<DRPacket> m_packet_list;
+  Statistics m_statistics;
+
+  void _p_scan();
+  void _p_add_field(int end);
+};
@@ -1,6 +1,7 @@
 #include "drserversocket.h"
 #include "qabstractsocket.h"
 
+#include <QDebug>
 #include <QTcpSocket>
 #include <QTimer>
 
@@ -48,7 +49,16 @@ void DRServerSocket::disconnect_from_server()
 {
   m_socket->close();
   m_socket->abort();
-  m_buffer.clear();
+
+  const DRPacketFramer::Statistics l_stats = m_framer.get_statistics();
+  if (l_stats.received_bytes > 0)
+  {
+    const double l_msecs = l_stats.elapsed_nsecs / 1000000.0;
+    const double l_throughput = l_msecs > 0 ? (l_stats.received_bytes / 1048576.0) / (l_msecs / 1000.0) : 0.0;
+    qDebug().noquote() << QString("Packet framing: %1 packet(s), %2 byte(s) in %3ms (%4 MiB/s)").arg(l_stats.framed_packets).arg(l_stats.received_bytes).arg(l_msecs, 0, 'f', 3).arg(l_throughput, 0, 'f', 1);
+  }
+  m_framer.clear();
+  m_framer.reset_statistics();
 }
 
 void DRServerSocket::send_packet(DRPacket p_packet)
@@ -102,15 +112,8 @@ void DRServerSocket::_p_check_socket_error()
 
 void DRServerSocket::_p_read_socket()
 {
-  m_buffer += QString::fromUtf8(m_socket->readAll());
-  QStringList l_raw_packet_list = m_buffer.split("#%", DR::KeepEmptyParts);
-  m_buffer = l_raw_packet_list.takeLast();
-  for (const QString &i_raw_packet : l_raw_packet_list)
-  {
-    QStringList l_raw_data_list = i_raw_packet.split("#");
-    const QString l_header = l_raw_data_list.takeFirst();
-    for (QString &i_raw_data : l_raw_data_list)
-      i_raw_data = DRPacket::decode(i_raw_data);
-    Q_EMIT packet_received(DRPacket(l_header, l_raw_data_list));
-  }
+  m_framer.append(m_socket->readAll());
+  const QVector<DRPacket> l_packet_list = m_framer.take_packets();
+  for (const DRPacket &i_packet : l_packet_list)
+    Q_EMIT packet_received(i_packet);
 }
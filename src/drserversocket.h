@@ -2,6 +2,7 @@
 
 #include "datatypes.h"
 #include "drpacket.h"
+#include "drpacketframer.h"
 
 #include <QAbstractSocket>
 #include <QObject>
@@ -44,7 +45,7 @@ private:
   QTcpSocket *m_socket = nullptr;
   QTimer *m_connecting_timeout = nullptr;
   ConnectionState m_state = NotConnected;
-  QString m_buffer;
+  DRPacketFramer m_framer;
 
 private slots:
   void _p_update_state(QAbstractSocket::SocketState);
@@ -3,9 +3,11 @@
 #include "drmediatester.h"
 #include "lobby.h"
 #include "logger.h"
+#include "modules/debug/profiler.h"
 #include "version.h"
 
 #include <QDebug>
+#include <QDir>
 
 int main(int argc, char *argv[])
 {
@@ -19,6 +21,7 @@ int main(int argc, char *argv[])
   qInfo() << "Starting Danganronpa Online...";
 
   bool l_dpi_scaling = false;
+  bool l_trace = false;
   for (int i = 0; i < argc; ++i)
   {
     const QString l_arg(argv[i]);
@@ -27,6 +30,10 @@ int main(int argc, char *argv[])
     {
       l_dpi_scaling = true;
     }
+    else if (l_arg == "-trace")
+    {
+      l_trace = true;
+    }
   }
 
   if (l_dpi_scaling)
@@ -43,6 +50,7 @@ int main(int argc, char *argv[])
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling, false);
   }
 
+  Profiler::get().SetEnabled(l_trace);
   AOApplication app(argc, argv);
 
   int l_exit_code = 0;
@@ -58,6 +66,12 @@ int main(int argc, char *argv[])
 
     l_exit_code = app.exec();
 
+    if (l_trace)
+    {
+      // open the file in chrome://tracing or ui.perfetto.dev
+      Profiler::get().ExportChromeTrace(QDir(QCoreApplication::applicationDirPath()).filePath("trace.json"));
+    }
+
     //logger::shutdown();
 
     if (l_config.autosave())
@@ -24,6 +24,7 @@
 
 #include <functional>
 
+#include <modules/debug/profiler.h>
 #include <modules/managers/scene_manager.h>
 
 using namespace mk2;
@@ -175,21 +176,26 @@ void GraphicsSpriteItem::paint(QPainter *painter, const QStyleOptionGraphicsItem
 {
   Q_UNUSED(option);
   Q_UNUSED(widget);
+  DR_PROFILE_SCOPE("GraphicsSpriteItem paint");
 
-
-  QImage l_image = m_player->get_current_frame();
+  const QImage l_image = m_player->get_current_frame();
   if (!l_image.isNull())
   {
+    // frames may be cropped to their opaque area, so sizes refer to the whole canvas
+    const QSize l_canvas_size = m_player->get_scaled_bounding_rect().size().toSize();
+    const QPoint l_offset = m_player->get_current_frame_offset();
+    QSize l_target_size = l_canvas_size;
     if(mWidgetAnimation != nullptr)
     {
       int lWidth = mWidgetAnimation->GetCurrentValue(eVarWidth);
       int lHeight = mWidgetAnimation->GetCurrentValue(eVarHeight);
       if(lWidth != 9999999 && lHeight != 9999999 && mWidgetAnimation->GetCurrentlyRunning())
       {
-        l_image = l_image.scaled(QSize(lWidth, lHeight), Qt::IgnoreAspectRatio);
-        update();
+        l_target_size = QSize(lWidth, lHeight);
       }
     }
+    const bool l_is_settled = l_target_size == m_paint_size;
+    m_paint_size = l_target_size;
 
     painter->save();
     painter->setCompositionMode(mCompoMode);
@@ -215,13 +221,46 @@ void GraphicsSpriteItem::paint(QPainter *painter, const QStyleOptionGraphicsItem
       painter->setRenderHint(QPainter::Antialiasing, true);
     }
 
-
-
-    painter->drawImage(l_horizontal_center, l_image);
+    if (l_target_size == l_canvas_size || l_target_size.isEmpty() || l_canvas_size.isEmpty())
+    {
+      painter->drawPixmap(l_horizontal_center + l_offset, get_frame_pixmap(l_image));
+    }
+    else
+    {
+      const qreal l_horizontal_factor = qreal(l_target_size.width()) / l_canvas_size.width();
+      const qreal l_vertical_factor = qreal(l_target_size.height()) / l_canvas_size.height();
+      if (l_is_settled)
+      {
+        const QSize l_settled_size(qMax(1, qRound(l_image.width() * l_horizontal_factor)), qMax(1, qRound(l_image.height() * l_vertical_factor)));
+        if (m_settled_pixmap_key != l_image.cacheKey() || m_settled_pixmap.size() != l_settled_size)
+        {
+          m_settled_pixmap = QPixmap::fromImage(l_image.scaled(l_settled_size, Qt::IgnoreAspectRatio));
+          m_settled_pixmap_key = l_image.cacheKey();
+        }
+        painter->drawPixmap(l_horizontal_center + QPointF(l_offset.x() * l_horizontal_factor, l_offset.y() * l_vertical_factor), m_settled_pixmap);
+      }
+      else
+      {
+        // still animating; scale while drawing instead of resampling the frame on every paint
+        painter->translate(l_horizontal_center);
+        painter->scale(l_horizontal_factor, l_vertical_factor);
+        painter->drawPixmap(QPointF(l_offset), get_frame_pixmap(l_image));
+      }
+    }
     painter->restore();
   }
 }
 
+const QPixmap &GraphicsSpriteItem::get_frame_pixmap(const QImage &p_image)
+{
+  if (m_frame_pixmap_key != p_image.cacheKey())
+  {
+    m_frame_pixmap = QPixmap::fromImage(p_image);
+    m_frame_pixmap_key = p_image.cacheKey();
+  }
+  return m_frame_pixmap;
+}
+
 void GraphicsSpriteItem::notify_size()
 {
   emit size_changed(QSizeF(m_player->get_size()));
@@ -26,6 +26,7 @@
 #include <QGraphicsObject>
 #include <QObject>
 #include <QPainter>
+#include <QPixmap>
 
 namespace mk2
 {
@@ -106,6 +107,16 @@ private:
   bool mCenterSprite = true;
   DROAnimation* mWidgetAnimation = nullptr;
 
+  // the current frame as a pixmap; animated sizes are applied as a painter transform on top of it
+  QPixmap m_frame_pixmap;
+  qint64 m_frame_pixmap_key = 0;
+  // resampled once the animated size stops changing
+  QPixmap m_settled_pixmap;
+  qint64 m_settled_pixmap_key = 0;
+  QSize m_paint_size;
+
+  const QPixmap &get_frame_pixmap(const QImage &image);
+
 private slots:
   void notify_size();
 
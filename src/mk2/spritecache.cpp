@@ -0,0 +1,246 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#include "mk2/spritecache.h"
+
+#include "modules/debug/profiler.h"
+#include "modules/managers/memory_manager.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+using namespace mk2;
+
+namespace
+{
+qint64 release_cached_memory(qint64 bytes);
+
+struct SpriteCacheData
+{
+  SpriteCacheData()
+  {
+    memory_consumer = MemoryManager::get().RegisterConsumer("sprite frames", MemoryManager::Priority::Cached, release_cached_memory);
+  }
+
+  ~SpriteCacheData()
+  {
+    // released entries report back to the consumer
+    cached_entries.clear();
+    MemoryManager::get().UnregisterConsumer(memory_consumer);
+  }
+
+  QMutex lock;
+  int memory_consumer = 0;
+  qint64 byte_budget = 256ll * 1024 * 1024;
+  qint64 memory_usage = 0;
+  bool frame_compression = false;
+  QHash<QString, QWeakPointer<SpriteCacheEntry>> live_entries;
+  QHash<QString, SpriteCacheEntry::ptr> cached_entries;
+  // most recently used first
+  QList<QString> lru_list;
+};
+
+SpriteCacheData &cache_data()
+{
+  static SpriteCacheData s_data;
+  return s_data;
+}
+
+// must be called with the lock held; evicted entries are returned so that
+// they can be released once the lock is gone
+QList<SpriteCacheEntry::ptr> evict_entries(SpriteCacheData &p_data, qint64 p_budget)
+{
+  QList<SpriteCacheEntry::ptr> l_evicted_list;
+  while (p_data.memory_usage > p_budget && !p_data.lru_list.isEmpty())
+  {
+    const QString l_key = p_data.lru_list.takeLast();
+    SpriteCacheEntry::ptr l_entry = p_data.cached_entries.take(l_key);
+    if (l_entry)
+    {
+      p_data.memory_usage -= l_entry->get_memory_usage();
+      l_evicted_list.append(l_entry);
+    }
+  }
+  return l_evicted_list;
+}
+
+// asked by the memory budget; entries still in use elsewhere only give their memory back once released there as well
+qint64 release_cached_memory(qint64 p_bytes)
+{
+  SpriteCacheData &l_data = cache_data();
+  QList<SpriteCacheEntry::ptr> l_evicted_list;
+  {
+    QMutexLocker l_locker(&l_data.lock);
+    l_evicted_list = evict_entries(l_data, qMax(0ll, l_data.memory_usage - p_bytes));
+    DR_PROFILE_COUNTER("sprite cache bytes", l_data.memory_usage);
+  }
+
+  qint64 l_released = 0;
+  for (const SpriteCacheEntry::ptr &i_entry : qAsConst(l_evicted_list))
+  {
+    l_released += i_entry->get_memory_usage();
+  }
+  return l_released;
+}
+} // namespace
+
+qint64 SpriteCache::get_byte_budget()
+{
+  SpriteCacheData &l_data = cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  return l_data.byte_budget;
+}
+
+void SpriteCache::set_byte_budget(qint64 p_bytes)
+{
+  SpriteCacheData &l_data = cache_data();
+  QList<SpriteCacheEntry::ptr> l_evicted_list;
+  {
+    QMutexLocker l_locker(&l_data.lock);
+    l_data.byte_budget = qMax(0ll, p_bytes);
+    l_evicted_list = evict_entries(l_data, l_data.byte_budget);
+  }
+}
+
+qint64 SpriteCache::get_memory_usage()
+{
+  SpriteCacheData &l_data = cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  return l_data.memory_usage;
+}
+
+bool SpriteCache::is_frame_compression_enabled()
+{
+  SpriteCacheData &l_data = cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  return l_data.frame_compression;
+}
+
+void SpriteCache::set_frame_compression_enabled(bool p_enabled)
+{
+  SpriteCacheData &l_data = cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  l_data.frame_compression = p_enabled;
+}
+
+void SpriteCache::account_frame_memory(qint64 p_bytes)
+{
+  MemoryManager::get().AddUsage(cache_data().memory_consumer, p_bytes);
+}
+
+QString SpriteCache::get_cache_key(QString p_file_name)
+{
+  if (p_file_name.isEmpty())
+  {
+    return QString{};
+  }
+
+  const QFileInfo l_file_info(p_file_name);
+  if (!l_file_info.isFile())
+  {
+    return QString{};
+  }
+
+  return QString("%1|%2|%3").arg(l_file_info.canonicalFilePath()).arg(l_file_info.lastModified().toMSecsSinceEpoch()).arg(l_file_info.size());
+}
+
+SpriteCacheEntry::ptr SpriteCache::find(QString p_file_name)
+{
+  const QString l_key = get_cache_key(p_file_name);
+  if (l_key.isEmpty())
+  {
+    return nullptr;
+  }
+
+  SpriteCacheData &l_data = cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  if (SpriteCacheEntry::ptr l_entry = l_data.cached_entries.value(l_key))
+  {
+    l_data.lru_list.removeOne(l_key);
+    l_data.lru_list.prepend(l_key);
+    return l_entry;
+  }
+
+  SpriteCacheEntry::ptr l_entry = l_data.live_entries.value(l_key).toStrongRef();
+  if (!l_entry || l_entry->get_last_error() != SpriteReader::Error::NoError)
+  {
+    l_data.live_entries.remove(l_key);
+    return nullptr;
+  }
+  return l_entry;
+}
+
+void SpriteCache::track(SpriteCacheEntry::ptr p_entry)
+{
+  if (!p_entry || p_entry->get_key().isEmpty())
+  {
+    return;
+  }
+
+  SpriteCacheData &l_data = cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  l_data.live_entries.insert(p_entry->get_key(), p_entry.toWeakRef());
+}
+
+void SpriteCache::insert(SpriteCacheEntry::ptr p_entry)
+{
+  if (!p_entry || p_entry->get_key().isEmpty() || !p_entry->is_loaded())
+  {
+    return;
+  }
+
+  const QString l_key = p_entry->get_key();
+  SpriteCacheData &l_data = cache_data();
+  QList<SpriteCacheEntry::ptr> l_evicted_list;
+  {
+    QMutexLocker l_locker(&l_data.lock);
+    if (l_data.cached_entries.contains(l_key) || p_entry->get_memory_usage() > l_data.byte_budget)
+    {
+      return;
+    }
+    l_data.live_entries.remove(l_key);
+
+    // make room first so the new entry is never the one being evicted
+    l_evicted_list = evict_entries(l_data, l_data.byte_budget - p_entry->get_memory_usage());
+    l_data.cached_entries.insert(l_key, p_entry);
+    l_data.lru_list.prepend(l_key);
+    l_data.memory_usage += p_entry->get_memory_usage();
+    DR_PROFILE_COUNTER("sprite cache bytes", l_data.memory_usage);
+  }
+}
+
+void SpriteCache::clear()
+{
+  SpriteCacheData &l_data = cache_data();
+  QHash<QString, SpriteCacheEntry::ptr> l_cached_entries;
+  {
+    QMutexLocker l_locker(&l_data.lock);
+    l_cached_entries = std::move(l_data.cached_entries);
+    l_data.cached_entries.clear();
+    l_data.live_entries.clear();
+    l_data.lru_list.clear();
+    l_data.memory_usage = 0;
+  }
+}
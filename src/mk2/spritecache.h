@@ -0,0 +1,65 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#pragma once
+
+#include "mk2/spritecacheentry.h"
+
+#include <QString>
+
+namespace mk2
+{
+/*!
+ * Process-wide index of decoded sprites.
+ *
+ * Entries that are still decoding are tracked weakly so that readers
+ * requesting the same file can attach to them. Fully decoded entries are kept
+ * alive until they fall out of the byte budget, least recently used first,
+ * or until the process memory budget asks for room.
+ */
+class SpriteCache
+{
+public:
+  static qint64 get_byte_budget();
+  static void set_byte_budget(qint64 bytes);
+
+  static qint64 get_memory_usage();
+
+  // applies to entries started afterwards
+  static bool is_frame_compression_enabled();
+  static void set_frame_compression_enabled(bool enabled);
+
+  // reports frames held by any entry, cached or not, to the process memory budget
+  static void account_frame_memory(qint64 bytes);
+
+  static QString get_cache_key(QString file_name);
+
+  static SpriteCacheEntry::ptr find(QString file_name);
+
+  static void track(SpriteCacheEntry::ptr entry);
+
+  static void insert(SpriteCacheEntry::ptr entry);
+
+  static void clear();
+
+private:
+  SpriteCache() = delete;
+};
+} // namespace mk2
@@ -0,0 +1,685 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#include "mk2/spritecacheentry.h"
+
+#include "mk2/spritecache.h"
+#include "mk2/spriteframecodec.h"
+#include "modules/debug/profiler.h"
+
+#include <QHash>
+#include <QImageReader>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QSemaphoreReleaser>
+#include <QSet>
+
+using namespace mk2;
+
+namespace
+{
+constexpr int s_decoded_window_size = 4;
+// decoding slows down when other sprites start decoding alongside
+constexpr double s_decode_time_margin = 1.25;
+
+QRect find_opaque_bounds(const QImage &p_image)
+{
+  const int l_width = p_image.width();
+  int l_left = l_width;
+  int l_right = -1;
+  int l_top = -1;
+  int l_bottom = -1;
+  for (int y = 0; y < p_image.height(); ++y)
+  {
+    const QRgb *l_line = reinterpret_cast<const QRgb *>(p_image.constScanLine(y));
+    int l_first = 0;
+    while (l_first < l_width && qAlpha(l_line[l_first]) == 0)
+    {
+      ++l_first;
+    }
+    if (l_first == l_width)
+    {
+      continue;
+    }
+
+    // columns already known to be opaque do not need to be looked at again
+    int l_last = l_width - 1;
+    while (l_last > qMax(l_first, l_right) && qAlpha(l_line[l_last]) == 0)
+    {
+      --l_last;
+    }
+
+    l_left = qMin(l_left, l_first);
+    l_right = qMax(l_right, l_last);
+    if (l_top == -1)
+    {
+      l_top = y;
+    }
+    l_bottom = y;
+  }
+
+  if (l_top == -1)
+  {
+    return QRect{};
+  }
+  return QRect(QPoint(l_left, l_top), QPoint(l_right, l_bottom));
+}
+} // namespace
+
+SpriteCacheEntry::SpriteCacheEntry(QString p_key, QObject *parent)
+    : QObject{parent}
+    , m_key{p_key}
+    , m_sprite_size{}
+    , m_frame_count{0}
+    , m_loop_count{0}
+    , m_memory_cached{true}
+    , m_compressed{false}
+    , m_memory_usage{0}
+    , m_state{SpriteReader::State::NotLoaded}
+    , m_last_error{SpriteReader::Error::NoError}
+    , m_loading_progress{0}
+    , m_exit_task{false}
+    , m_priority{SpriteDecodeScheduler::Priority::Speculative}
+{
+  SpriteReader::registerMetatypes();
+}
+
+SpriteCacheEntry::~SpriteCacheEntry()
+{
+  _p_stop_preload();
+  _p_set_memory_usage(0);
+}
+
+QString SpriteCacheEntry::get_key() const
+{
+  return m_key;
+}
+
+QSize SpriteCacheEntry::get_sprite_size() const
+{
+  return m_sprite_size;
+}
+
+int SpriteCacheEntry::get_frame_count() const
+{
+  return m_frame_count;
+}
+
+int SpriteCacheEntry::get_loop_count() const
+{
+  return m_loop_count;
+}
+
+SpriteFrame SpriteCacheEntry::get_frame(int p_number)
+{
+  if (m_frame_count <= 0)
+  {
+    return SpriteFrame{};
+  }
+  p_number = qBound(0, p_number, qMax(m_frame_count - 1, 0));
+  m_available_frames.acquire(p_number + 1);
+  QSemaphoreReleaser l_releaser(m_available_frames, p_number + 1);
+  QMutexLocker l_locker(&m_lock);
+  if (m_compressed)
+  {
+    return _p_unpack_frame(p_number, l_locker);
+  }
+  return m_frame_list.at(p_number);
+}
+
+bool SpriteCacheEntry::can_play_through(int p_preroll_frames) const
+{
+  if (is_loaded())
+  {
+    return true;
+  }
+
+  QMutexLocker l_locker(&m_lock);
+  const int l_decoded_count = m_frame_list.length();
+  if (!m_decode_timer.isValid() || l_decoded_count == 0 || l_decoded_count < qMin(p_preroll_frames, m_frame_count))
+  {
+    return false;
+  }
+
+  qint64 l_buffered_time = 0;
+  for (const SpriteFrame &i_frame : m_frame_list)
+  {
+    l_buffered_time += qMax(0, i_frame.delay);
+  }
+  const double l_frame_decode_time = double(qMax(1ll, m_decode_timer.elapsed())) / l_decoded_count * s_decode_time_margin;
+  const double l_average_delay = double(l_buffered_time) / l_decoded_count;
+  const int l_remaining_count = m_frame_count - l_decoded_count;
+  if (l_remaining_count <= 0)
+  {
+    return true;
+  }
+
+  // both sides grow linearly with the frame number, so the next and the last frame bound every frame in between
+  const bool l_next_in_time = l_frame_decode_time <= l_buffered_time;
+  const bool l_last_in_time = l_remaining_count * l_frame_decode_time <= l_buffered_time + (l_remaining_count - 1) * l_average_delay;
+  return l_next_in_time && l_last_in_time;
+}
+
+QVector<SpriteFrame> SpriteCacheEntry::get_frame_list()
+{
+  m_available_frames.acquire(m_frame_count);
+  QSemaphoreReleaser l_releaser(m_available_frames, m_frame_count);
+  QMutexLocker l_locker(&m_lock);
+  if (m_compressed)
+  {
+    QVector<SpriteFrame> l_frame_list;
+    for (int i = 0; i < m_frame_count; ++i)
+    {
+      l_frame_list.append(_p_unpack_frame(i, l_locker));
+    }
+    return l_frame_list;
+  }
+  return m_frame_list;
+}
+
+SpriteReader::State SpriteCacheEntry::get_state() const
+{
+  return m_state;
+}
+
+bool SpriteCacheEntry::is_loaded() const
+{
+  return m_state == SpriteReader::State::FullyLoaded;
+}
+
+int SpriteCacheEntry::get_loading_progress() const
+{
+  return m_loading_progress;
+}
+
+SpriteReader::Error SpriteCacheEntry::get_last_error() const
+{
+  return m_last_error;
+}
+
+qint64 SpriteCacheEntry::get_memory_usage() const
+{
+  return m_memory_usage;
+}
+
+bool SpriteCacheEntry::is_compressed() const
+{
+  return m_compressed;
+}
+
+bool SpriteCacheEntry::start(SpriteMappedFile::ptr p_source)
+{
+  _p_stop_preload();
+  if (!_p_read_header(p_source))
+  {
+    return false;
+  }
+  m_exit_task = false;
+  SpriteDecodeScheduler::submit(this, p_source, m_priority);
+  return true;
+}
+
+bool SpriteCacheEntry::decode(SpriteMappedFile::ptr p_source)
+{
+  _p_stop_preload();
+  if (!_p_read_header(p_source))
+  {
+    return false;
+  }
+  m_memory_cached = false;
+  m_exit_task = false;
+  _p_decode(p_source);
+  return is_loaded();
+}
+
+SpriteDecodeScheduler::Priority SpriteCacheEntry::get_priority() const
+{
+  return m_priority;
+}
+
+void SpriteCacheEntry::add_priority_request(SpriteDecodeScheduler::Priority p_priority)
+{
+  ++m_priority_requests[int(p_priority)];
+  _p_update_priority();
+}
+
+void SpriteCacheEntry::remove_priority_request(SpriteDecodeScheduler::Priority p_priority)
+{
+  m_priority_requests[int(p_priority)] = qMax(0, m_priority_requests[int(p_priority)] - 1);
+  _p_update_priority();
+}
+
+void SpriteCacheEntry::_p_update_priority()
+{
+  SpriteDecodeScheduler::Priority l_priority = SpriteDecodeScheduler::Priority::Speculative;
+  for (int i = 0; i < SpriteDecodeScheduler::PriorityCount; ++i)
+  {
+    if (m_priority_requests[i] > 0)
+    {
+      l_priority = SpriteDecodeScheduler::Priority(i);
+      break;
+    }
+  }
+
+  if (m_priority == l_priority)
+  {
+    return;
+  }
+  m_priority = l_priority;
+  SpriteDecodeScheduler::set_priority(this, m_priority);
+}
+
+// must be called with the lock held; it is released while the frame is being expanded
+SpriteFrame SpriteCacheEntry::_p_unpack_frame(int p_number, QMutexLocker &p_locker)
+{
+  SpriteFrame l_frame = m_frame_list.at(p_number);
+  // repeated frames share their packed data
+  l_frame.source_key = qint64(quintptr(m_packed_frame_list.at(p_number).constData()));
+  if (m_decoded_window.contains(p_number))
+  {
+    // the window is cleared whenever the crop changes, so its images always match the current one
+    l_frame.image = m_decoded_window.value(p_number);
+    if (m_crop_rect.isValid())
+    {
+      l_frame.offset = m_crop_rect.topLeft();
+    }
+    return l_frame;
+  }
+
+  const QByteArray l_data = m_packed_frame_list.at(p_number);
+  const QSize l_packed_frame_size = m_packed_frame_size;
+  const QRect l_crop_rect = m_crop_rect;
+  p_locker.unlock();
+  l_frame.image = SpriteFrameCodec::decode(l_data, l_packed_frame_size);
+  if (l_crop_rect.isValid())
+  {
+    // frames from the disk cache may have been packed after cropping
+    if (l_frame.image.size() != l_crop_rect.size())
+    {
+      l_frame.image = l_frame.image.copy(l_crop_rect);
+    }
+    l_frame.offset = l_crop_rect.topLeft();
+  }
+  p_locker.relock();
+
+  // the frames were cropped while this one was being expanded; it no longer belongs in the window
+  if (m_crop_rect != l_crop_rect)
+  {
+    return l_frame;
+  }
+
+  m_decoded_window.insert(p_number, l_frame.image);
+  while (m_decoded_window.size() > s_decoded_window_size)
+  {
+    // drop the frame furthest away from the playhead, counting across the loop
+    int l_furthest_number = -1;
+    int l_furthest_distance = -1;
+    for (auto it = m_decoded_window.cbegin(); it != m_decoded_window.cend(); ++it)
+    {
+      const int l_distance = qAbs(it.key() - p_number);
+      const int l_loop_distance = qMin(l_distance, m_frame_count - l_distance);
+      if (l_loop_distance > l_furthest_distance)
+      {
+        l_furthest_number = it.key();
+        l_furthest_distance = l_loop_distance;
+      }
+    }
+    m_decoded_window.remove(l_furthest_number);
+  }
+  return l_frame;
+}
+
+void SpriteCacheEntry::_p_stop_preload()
+{
+  m_exit_task = true;
+  SpriteDecodeScheduler::cancel(this);
+}
+
+bool SpriteCacheEntry::_p_read_header(SpriteMappedFile::ptr p_source)
+{
+  SpriteMappedDevice l_device(p_source);
+  l_device.open(QIODevice::ReadOnly);
+  QImageReader l_reader(&l_device);
+  if (!l_reader.canRead())
+  {
+    _p_set_error(SpriteReader::Error::InvalidDataError);
+    return false;
+  }
+  m_sprite_size = l_reader.size();
+  m_frame_count = l_reader.imageCount();
+  m_loop_count = l_reader.loopCount();
+  m_packed_frame_size = m_sprite_size;
+  m_compressed = SpriteCache::is_frame_compression_enabled();
+  return true;
+}
+
+void SpriteCacheEntry::_p_decode(SpriteMappedFile::ptr p_source)
+{
+  DR_PROFILE_SCOPE("SpriteCacheEntry decode");
+  _p_set_state(SpriteReader::State::NotLoaded);
+  _p_set_loading_progress(0);
+  {
+    QMutexLocker l_locker(&m_lock);
+    m_decode_timer.start();
+  }
+
+  // a transcoded copy spares the codec entirely
+  const bool l_from_disk = _p_load_record(SpriteDiskCache::find(m_key, p_source));
+
+  SpriteMappedDevice l_device(p_source);
+  l_device.open(QIODevice::ReadOnly);
+  QImageReader l_reader(&l_device);
+  const QSize l_size = m_sprite_size;
+  const int l_frame_count = l_from_disk ? 0 : l_reader.imageCount();
+  if (l_from_disk)
+  {
+    if (!m_exit_task)
+    {
+      _p_set_loading_progress(100);
+      _p_set_state(SpriteReader::State::FullyLoaded);
+    }
+  }
+  else if (l_frame_count > 0)
+  {
+    // decoders may composite onto the previous frame, so the buffer itself is never converted
+    QImage l_image_buffer(l_size, QImage::Format_ARGB32);
+
+    qint64 l_memory_usage = 0;
+    QRect l_opaque_rect;
+    // repeated frames share the pixels of their first occurrence
+    QHash<uint, QVector<QImage>> l_unique_image_map;
+    QSet<QByteArray> l_unique_packed_frame_set;
+    int l_frame_number = 0;
+    int l_percent_progress = 0;
+    while (!m_exit_task && l_frame_number < l_frame_count && l_reader.canRead())
+    {
+      SpriteFrame l_frame;
+      {
+        DR_PROFILE_SCOPE("SpriteCacheEntry decode frame");
+        l_reader.read(&l_image_buffer);
+      }
+      l_frame.delay = l_reader.nextImageDelay();
+      const QImage l_image = l_image_buffer.convertToFormat(SpriteFrame::image_format);
+      bool l_is_duplicate = false;
+      QByteArray l_packed_frame;
+      if (m_compressed)
+      {
+        // the codec is deterministic, so identical frames pack to identical data
+        l_packed_frame = SpriteFrameCodec::encode(l_image);
+        const auto l_it = l_unique_packed_frame_set.constFind(l_packed_frame);
+        l_is_duplicate = l_it != l_unique_packed_frame_set.constEnd();
+        if (l_is_duplicate)
+        {
+          l_packed_frame = *l_it;
+        }
+        else
+        {
+          l_unique_packed_frame_set.insert(l_packed_frame);
+          l_memory_usage += l_packed_frame.size();
+        }
+      }
+      else
+      {
+        l_frame.image = l_image;
+        QVector<QImage> &l_candidate_list = l_unique_image_map[qHashBits(l_image.constBits(), size_t(l_image.sizeInBytes()))];
+        for (const QImage &i_image : qAsConst(l_candidate_list))
+        {
+          if (i_image == l_image)
+          {
+            l_frame.image = i_image;
+            l_is_duplicate = true;
+            break;
+          }
+        }
+        if (!l_is_duplicate)
+        {
+          l_candidate_list.append(l_image);
+          l_memory_usage += l_frame.image.sizeInBytes();
+        }
+      }
+      if (!l_is_duplicate)
+      {
+        l_opaque_rect |= find_opaque_bounds(l_image);
+      }
+      {
+        QMutexLocker locker(&m_lock);
+        if (m_compressed)
+        {
+          m_packed_frame_list.append(std::move(l_packed_frame));
+        }
+        m_frame_list.append(std::move(l_frame));
+        l_frame_number = m_frame_list.length();
+        m_available_frames.release();
+      }
+
+      l_percent_progress = ((double)l_frame_number / (l_frame_count + 1)) * 100;
+      _p_set_loading_progress(l_percent_progress);
+    }
+    _p_set_memory_usage(l_memory_usage);
+
+    if (!m_exit_task)
+    {
+      // fully transparent animations are left alone
+      if (l_opaque_rect.isValid() && l_opaque_rect != QRect(QPoint(0, 0), l_size))
+      {
+        _p_crop_frames(l_opaque_rect);
+      }
+
+      _p_set_loading_progress(100);
+      _p_set_state(SpriteReader::State::FullyLoaded);
+
+      // still images decode quickly enough on their own
+      if (m_frame_count > 1)
+      {
+        _p_store_record(p_source);
+      }
+    }
+  }
+  else
+  {
+    _p_set_error(SpriteReader::Error::InvalidDataError);
+  }
+
+  if (is_loaded() && m_memory_cached)
+  {
+    // the cache is only touched from the thread owning the entry
+    QMetaObject::invokeMethod(
+        this,
+        [this]() {
+          SpriteCache::insert(sharedFromThis());
+        },
+        Qt::QueuedConnection);
+  }
+}
+
+bool SpriteCacheEntry::_p_load_record(SpriteDiskRecord::ptr p_record)
+{
+  if (!p_record || p_record->sprite_size != m_sprite_size || p_record->get_frame_count() != m_frame_count)
+  {
+    return false;
+  }
+
+  DR_PROFILE_SCOPE("SpriteCacheEntry load record");
+  m_loop_count = p_record->loop_count;
+  {
+    QMutexLocker l_locker(&m_lock);
+    m_packed_frame_size = p_record->packed_frame_size;
+    m_crop_rect = p_record->crop_rect;
+    if (m_compressed)
+    {
+      // the packed frames stay in the mapped record
+      m_disk_record = p_record;
+    }
+  }
+
+  // shared frames in the record are shared in memory as well
+  QHash<const char *, QImage> l_image_map;
+  QSet<const char *> l_packed_frame_set;
+  qint64 l_memory_usage = 0;
+  for (int i = 0; i < m_frame_count && !m_exit_task; ++i)
+  {
+    const QByteArray &l_packed_frame = p_record->packed_frame_list.at(i);
+    SpriteFrame l_frame;
+    l_frame.delay = p_record->delay_list.at(i);
+    if (m_compressed)
+    {
+      if (!l_packed_frame_set.contains(l_packed_frame.constData()))
+      {
+        l_packed_frame_set.insert(l_packed_frame.constData());
+        l_memory_usage += l_packed_frame.size();
+      }
+    }
+    else if (l_image_map.contains(l_packed_frame.constData()))
+    {
+      l_frame.image = l_image_map.value(l_packed_frame.constData());
+      l_frame.offset = p_record->crop_rect.isValid() ? p_record->crop_rect.topLeft() : QPoint{};
+    }
+    else
+    {
+      l_frame = p_record->get_frame(i);
+      l_image_map.insert(l_packed_frame.constData(), l_frame.image);
+      l_memory_usage += l_frame.image.sizeInBytes();
+    }
+
+    {
+      QMutexLocker l_locker(&m_lock);
+      if (m_compressed)
+      {
+        m_packed_frame_list.append(l_packed_frame);
+      }
+      m_frame_list.append(std::move(l_frame));
+      m_available_frames.release();
+    }
+    _p_set_loading_progress(((double)(i + 1) / (m_frame_count + 1)) * 100);
+  }
+  _p_set_memory_usage(l_memory_usage);
+  return true;
+}
+
+void SpriteCacheEntry::_p_crop_frames(QRect p_rect)
+{
+  DR_PROFILE_SCOPE("SpriteCacheEntry crop");
+  QMutexLocker l_locker(&m_lock);
+  m_crop_rect = p_rect;
+  if (m_compressed)
+  {
+    // packed frames are cropped as they are expanded
+    m_decoded_window.clear();
+    return;
+  }
+
+  // keep repeated frames shared
+  QHash<qint64, QImage> l_cropped_image_map;
+  qint64 l_memory_usage = 0;
+  for (SpriteFrame &i_frame : m_frame_list)
+  {
+    const qint64 l_source_key = i_frame.image.cacheKey();
+    if (l_cropped_image_map.contains(l_source_key))
+    {
+      i_frame.image = l_cropped_image_map.value(l_source_key);
+    }
+    else
+    {
+      i_frame.image = i_frame.image.copy(p_rect);
+      l_cropped_image_map.insert(l_source_key, i_frame.image);
+      l_memory_usage += i_frame.image.sizeInBytes();
+    }
+    i_frame.offset = p_rect.topLeft();
+  }
+  _p_set_memory_usage(l_memory_usage);
+}
+
+void SpriteCacheEntry::_p_set_memory_usage(qint64 p_bytes)
+{
+  SpriteCache::account_frame_memory(p_bytes - m_memory_usage.exchange(p_bytes));
+}
+
+void SpriteCacheEntry::_p_store_record(SpriteMappedFile::ptr p_source)
+{
+  if (!SpriteDiskCache::is_enabled())
+  {
+    return;
+  }
+
+  SpriteDiskRecord l_record;
+  l_record.sprite_size = m_sprite_size;
+  l_record.loop_count = m_loop_count;
+  QVector<SpriteFrame> l_frame_list;
+  {
+    QMutexLocker l_locker(&m_lock);
+    l_record.packed_frame_size = m_packed_frame_size;
+    l_record.crop_rect = m_crop_rect;
+    l_record.packed_frame_list = m_packed_frame_list;
+    l_frame_list = m_frame_list;
+  }
+
+  if (!m_compressed)
+  {
+    // cropped frames are packed as they are
+    QHash<qint64, QByteArray> l_packed_frame_map;
+    for (const SpriteFrame &i_frame : qAsConst(l_frame_list))
+    {
+      const qint64 l_image_key = i_frame.image.cacheKey();
+      if (!l_packed_frame_map.contains(l_image_key))
+      {
+        l_packed_frame_map.insert(l_image_key, SpriteFrameCodec::encode(i_frame.image));
+      }
+      l_record.packed_frame_list.append(l_packed_frame_map.value(l_image_key));
+      l_record.packed_frame_size = i_frame.image.size();
+    }
+  }
+
+  for (const SpriteFrame &i_frame : qAsConst(l_frame_list))
+  {
+    l_record.delay_list.append(i_frame.delay);
+  }
+  // background decodes must not push out the records of sprites that were actually shown
+  SpriteDiskCache::store(m_key, p_source, l_record, m_memory_cached);
+}
+
+void SpriteCacheEntry::_p_set_state(SpriteReader::State p_state)
+{
+  if (m_state == p_state)
+  {
+    return;
+  }
+  m_state = p_state;
+  emit state_changed(m_state);
+}
+
+void SpriteCacheEntry::_p_set_loading_progress(int p_progress)
+{
+  p_progress = qBound(0, p_progress, 100);
+  if (m_loading_progress == p_progress)
+  {
+    return;
+  }
+  m_loading_progress = p_progress;
+  emit loading_progress_changed(m_loading_progress);
+}
+
+void SpriteCacheEntry::_p_set_error(SpriteReader::Error p_error)
+{
+  m_last_error = p_error;
+  if (m_last_error != SpriteReader::Error::NoError)
+  {
+    emit error(m_last_error);
+  }
+}
@@ -0,0 +1,158 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#pragma once
+
+#include "mk2/spritedecodescheduler.h"
+#include "mk2/spritediskcache.h"
+#include "mk2/spritereader.h"
+
+#include <QElapsedTimer>
+#include <QEnableSharedFromThis>
+#include <QMap>
+#include <QMutex>
+#include <QSemaphore>
+
+#include <atomic>
+
+namespace mk2
+{
+/*!
+ * Decoded frames of a single sprite file.
+ *
+ * An entry owns the decoding task and may be shared by any number of readers,
+ * either while it is still decoding or once it is fully loaded. The decode is
+ * scheduled with the most urgent priority requested by those readers.
+ *
+ * With frame compression enabled, frames are stored compressed and expanded
+ * on request; only a few frames around the last requested one are kept
+ * decoded.
+ *
+ * Once fully decoded, frames are cropped to the opaque area shared by the
+ * whole animation. Frames handed out before that keep the full canvas.
+ * Identical frames share their pixels.
+ *
+ * Animations are read from the disk cache when it holds them and written to
+ * it after their first decode.
+ */
+class SpriteCacheEntry : public QObject, public QEnableSharedFromThis<SpriteCacheEntry>
+{
+  Q_OBJECT
+
+public:
+  using ptr = QSharedPointer<SpriteCacheEntry>;
+
+  explicit SpriteCacheEntry(QString key, QObject *parent = nullptr);
+  ~SpriteCacheEntry();
+
+  QString get_key() const;
+
+  QSize get_sprite_size() const;
+
+  int get_frame_count() const;
+
+  int get_loop_count() const;
+
+  SpriteFrame get_frame(int number);
+
+  QVector<SpriteFrame> get_frame_list();
+
+  // compares the decode rate so far against the delays of the frames decoded so far
+  bool can_play_through(int preroll_frames) const;
+
+  mk2::SpriteReader::State get_state() const;
+
+  bool is_loaded() const;
+
+  int get_loading_progress() const;
+
+  mk2::SpriteReader::Error get_last_error() const;
+
+  qint64 get_memory_usage() const;
+
+  bool is_compressed() const;
+
+  bool start(SpriteMappedFile::ptr source);
+
+  // decodes on the calling thread without making the entry available to the memory cache; the frames are only stored
+  // on disk when they fit within the disk cache budget without evicting other records
+  bool decode(SpriteMappedFile::ptr source);
+
+  SpriteDecodeScheduler::Priority get_priority() const;
+
+  void add_priority_request(SpriteDecodeScheduler::Priority priority);
+
+  void remove_priority_request(SpriteDecodeScheduler::Priority priority);
+
+signals:
+  void state_changed(mk2::SpriteReader::State state);
+
+  void loading_progress_changed(int);
+
+  void error(mk2::SpriteReader::Error error);
+
+private:
+  const QString m_key;
+  mutable QMutex m_lock;
+
+  QSize m_sprite_size;
+  int m_frame_count;
+  std::atomic_int m_loop_count;
+  bool m_memory_cached;
+  mutable QSemaphore m_available_frames;
+  QVector<SpriteFrame> m_frame_list;
+  // when compressed, m_frame_list only holds the delays
+  bool m_compressed;
+  QVector<QByteArray> m_packed_frame_list;
+  QSize m_packed_frame_size;
+  // keeps packed frames read from the disk cache mapped
+  SpriteDiskRecord::ptr m_disk_record;
+  QMap<int, QImage> m_decoded_window;
+  // opaque area of the whole animation, valid once the frames are cropped
+  QRect m_crop_rect;
+  QElapsedTimer m_decode_timer;
+  std::atomic<qint64> m_memory_usage;
+
+  std::atomic<SpriteReader::State> m_state;
+  std::atomic<SpriteReader::Error> m_last_error;
+  std::atomic_int m_loading_progress;
+
+  std::atomic_bool m_exit_task;
+  // number of readers requesting each priority
+  int m_priority_requests[SpriteDecodeScheduler::PriorityCount] = {};
+  SpriteDecodeScheduler::Priority m_priority;
+
+  friend class SpriteDecodeScheduler;
+
+  bool _p_read_header(SpriteMappedFile::ptr source);
+  void _p_decode(SpriteMappedFile::ptr source);
+  bool _p_load_record(SpriteDiskRecord::ptr record);
+  void _p_crop_frames(QRect rect);
+  // keeps the process memory budget in step with the frames held
+  void _p_set_memory_usage(qint64 bytes);
+  void _p_store_record(SpriteMappedFile::ptr source);
+  void _p_update_priority();
+  SpriteFrame _p_unpack_frame(int number, QMutexLocker &locker);
+  void _p_stop_preload();
+  void _p_set_state(SpriteReader::State state);
+  void _p_set_loading_progress(int percent);
+  void _p_set_error(SpriteReader::Error error);
+};
+} // namespace mk2
@@ -20,36 +20,32 @@
 
 #include "mk2/spritecachingreader.h"
 
-#include <QElapsedTimer>
-#include <QImageReader>
-#include <QMutexLocker>
-#include <QSemaphoreReleaser>
-#include <QtConcurrent/QtConcurrentRun>
-
-#include <QBuffer>
+#include "mk2/spritecache.h"
 
 using namespace mk2;
 
 SpriteCachingReader::SpriteCachingReader(QObject *parent)
     : SpriteReader{parent}
-    , m_sprite_size{}
-    , m_frame_count{0}
-    , m_exit_task{false}
 {}
 
 SpriteCachingReader::~SpriteCachingReader()
 {
-  _p_stop_preload();
+  _p_detach_entry();
+}
+
+bool SpriteCachingReader::is_caching() const
+{
+  return true;
 }
 
 QSize SpriteCachingReader::get_sprite_size() const
 {
-  return m_sprite_size;
+  return m_entry ? m_entry->get_sprite_size() : QSize{};
 }
 
 int SpriteCachingReader::get_frame_count() const
 {
-  return m_frame_count;
+  return m_entry ? m_entry->get_frame_count() : 0;
 }
 
 SpriteFrame SpriteCachingReader::get_frame(int p_number)
@@ -58,112 +54,92 @@ SpriteFrame SpriteCachingReader::get_frame(int p_number)
   {
     return SpriteFrame{};
   }
-  p_number = qBound(0, p_number, qMax(m_frame_count - 1, 0));
-  m_available_frames.acquire(p_number + 1);
-  QSemaphoreReleaser l_releaser(m_available_frames, p_number + 1);
-  QMutexLocker l_locker(&m_lock);
-  return m_frame_list.at(p_number);
+  return m_entry->get_frame(p_number);
 }
 
 QVector<SpriteFrame> SpriteCachingReader::get_frame_list()
 {
-  m_available_frames.acquire(get_frame_count());
-  QSemaphoreReleaser l_releaser(m_available_frames, get_frame_count());
-  QMutexLocker l_locker(&m_lock);
-  return m_frame_list;
+  if (!is_valid())
+  {
+    return QVector<SpriteFrame>{};
+  }
+  return m_entry->get_frame_list();
+}
+
+bool SpriteCachingReader::can_play_through(int p_preroll_frames) const
+{
+  if (!is_valid())
+  {
+    return false;
+  }
+  return m_entry->can_play_through(p_preroll_frames);
+}
+
+void SpriteCachingReader::set_decode_priority(SpriteDecodeScheduler::Priority p_priority)
+{
+  if (m_entry)
+  {
+    m_entry->add_priority_request(p_priority);
+    m_entry->remove_priority_request(get_decode_priority());
+  }
+  SpriteReader::set_decode_priority(p_priority);
 }
 
 void SpriteCachingReader::load()
 {
-  _p_stop_preload();
-  m_available_frames.acquire(m_available_frames.available());
-  m_sprite_size = QSize{};
-  m_frame_count = 0;
-  m_frame_list.clear();
-
-  QByteArray l_raw_data;
-  QIODevice *l_device = get_device();
-  const int l_prev_pos = l_device->pos();
-  if (!l_device->isOpen() && !l_device->open(QIODevice::ReadOnly))
+  _p_detach_entry();
+
+  // attach to an already decoded (or decoding) sprite when possible
+  const QString l_file_name = get_file_name();
+  if (SpriteCacheEntry::ptr l_entry = SpriteCache::find(l_file_name))
   {
-    set_error(Error::DeviceError);
+    _p_attach_entry(l_entry);
     return;
   }
-  l_device->seek(0);
-  l_raw_data = l_device->readAll();
-  l_device->seek(l_prev_pos);
 
+  // mapped rather than read, the decoder pulls the bytes in on its own thread
+  const SpriteMappedFile::ptr l_source = SpriteMappedFile::open(get_device());
+  if (!l_source)
   {
-    QBuffer l_buffer(&l_raw_data);
-    QImageReader l_reader(&l_buffer);
-    if (!l_reader.canRead())
-    {
-      set_error(Error::InvalidDataError);
-      return;
-    }
-    m_sprite_size = l_reader.size();
-    m_frame_count = l_reader.imageCount();
+    set_error(Error::DeviceError);
+    return;
   }
 
-  m_exit_task = false;
-  m_task = QtConcurrent::run(this, &SpriteCachingReader::_p_preload, l_raw_data);
+  // attached first so that the decode is submitted with this reader's priority
+  SpriteCacheEntry::ptr l_entry(new SpriteCacheEntry(SpriteCache::get_cache_key(l_file_name)));
+  _p_attach_entry(l_entry);
+  if (!l_entry->start(l_source))
+  {
+    _p_detach_entry();
+    set_error(Error::InvalidDataError);
+    return;
+  }
+  SpriteCache::track(l_entry);
 }
 
-void SpriteCachingReader::_p_stop_preload()
+void SpriteCachingReader::_p_attach_entry(SpriteCacheEntry::ptr p_entry)
 {
-  m_exit_task = true;
-  m_task.waitForFinished();
+  m_entry = p_entry;
+  m_entry->add_priority_request(get_decode_priority());
+  // the entry reports from its decoding thread; progress is relayed through the event loop so that a
+  // reader can be released while the entry keeps decoding for others
+  connect(m_entry.data(), SIGNAL(state_changed(mk2::SpriteReader::State)), this, SLOT(set_state(mk2::SpriteReader::State)));
+  connect(m_entry.data(), SIGNAL(loading_progress_changed(int)), this, SLOT(set_loading_progress(int)));
+  connect(m_entry.data(), SIGNAL(error(mk2::SpriteReader::Error)), this, SLOT(set_error(mk2::SpriteReader::Error)));
+  set_loading_progress(m_entry->get_loading_progress());
+  set_state(m_entry->get_state());
+  if (m_entry->get_last_error() != Error::NoError)
+  {
+    set_error(m_entry->get_last_error());
+  }
 }
 
-void SpriteCachingReader::_p_preload(QByteArray p_raw_data)
+void SpriteCachingReader::_p_detach_entry()
 {
-  set_state(State::NotLoaded);
-  set_loading_progress(0);
-
-  QBuffer l_buffer(&p_raw_data);
-  QImageReader l_reader(&l_buffer);
-  const QSize l_size = l_reader.size();
-  const int l_frame_count = l_reader.imageCount();
-  if (l_frame_count > 0)
+  if (m_entry)
   {
-    QElapsedTimer l_elapsed_timer;
-    l_elapsed_timer.start();
-
-    // create a buffer for images
-    QVector<QImage> l_image_buffer_list;
-    for (int i = 0; i < l_frame_count; ++i)
-    {
-      l_image_buffer_list.append(QImage(l_size, QImage::Format_ARGB32));
-    }
-
-    int l_frame_number = 0;
-    int l_percent_progress = 0;
-    while (!m_exit_task && l_frame_number < l_frame_count && l_reader.canRead())
-    {
-      SpriteFrame l_frame;
-      QImage l_image_buffer = l_image_buffer_list.takeFirst();
-      l_reader.read(&l_image_buffer);
-      l_frame.image = l_image_buffer;
-      l_frame.delay = l_reader.nextImageDelay();
-      {
-        QMutexLocker locker(&m_lock);
-        m_frame_list.append(std::move(l_frame));
-        l_frame_number = m_frame_list.length();
-        m_available_frames.release();
-      }
-
-      l_percent_progress = ((double)l_frame_number / (l_frame_count + 1)) * 100;
-      set_loading_progress(l_percent_progress);
-    }
-
-    if (!m_exit_task)
-    {
-      set_loading_progress(100);
-      set_state(State::FullyLoaded);
-    }
-  }
-  else
-  {
-    set_error(Error::InvalidDataError);
+    m_entry->disconnect(this);
+    m_entry->remove_priority_request(get_decode_priority());
+    m_entry.reset();
   }
 }
@@ -20,14 +20,9 @@
 
 #pragma once
 
+#include "mk2/spritecacheentry.h"
 #include "mk2/spritereader.h"
 
-#include <QFuture>
-#include <QMutex>
-#include <QSemaphore>
-
-#include <atomic>
-
 namespace mk2
 {
 class SpriteCachingReader : public SpriteReader
@@ -39,6 +34,8 @@ public:
   virtual ~SpriteCachingReader();
 
 public:
+  bool is_caching() const final;
+
   QSize get_sprite_size() const final;
 
   int get_frame_count() const final;
@@ -47,21 +44,17 @@ public:
 
   QVector<SpriteFrame> get_frame_list() final;
 
+  bool can_play_through(int preroll_frames) const final;
+
+  void set_decode_priority(SpriteDecodeScheduler::Priority priority) final;
+
 protected:
   void load() final;
 
 private:
-  mutable QMutex m_lock;
-
-  QSize m_sprite_size;
-  int m_frame_count;
-  mutable QSemaphore m_available_frames;
-  QVector<SpriteFrame> m_frame_list;
-
-  QFuture<void> m_task;
-  std::atomic_bool m_exit_task;
+  SpriteCacheEntry::ptr m_entry;
 
-  void _p_preload(QByteArray raw_data);
-  void _p_stop_preload();
+  void _p_attach_entry(SpriteCacheEntry::ptr entry);
+  void _p_detach_entry();
 };
 } // namespace mk2
@@ -0,0 +1,224 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#include "mk2/spritedecodescheduler.h"
+
+#include "mk2/spritecacheentry.h"
+#include "modules/debug/profiler.h"
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <array>
+
+namespace mk2
+{
+class SpriteDecodeTask : public QRunnable
+{
+public:
+  void run() final
+  {
+    SpriteDecodeScheduler::_p_run_next();
+  }
+};
+} // namespace mk2
+
+using namespace mk2;
+
+namespace
+{
+struct SpriteDecodeJob
+{
+  SpriteCacheEntry *entry = nullptr;
+  SpriteMappedFile::ptr source;
+};
+
+struct SpriteDecodeSchedulerData
+{
+  QMutex lock;
+  QWaitCondition finished;
+  QThreadPool pool;
+  std::array<QList<SpriteDecodeJob>, SpriteDecodeScheduler::PriorityCount> queue_list;
+  QSet<SpriteCacheEntry *> running_entries;
+
+  SpriteDecodeSchedulerData()
+  {
+    pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() - 1, 4));
+  }
+};
+
+SpriteDecodeSchedulerData &scheduler_data()
+{
+  static SpriteDecodeSchedulerData s_data;
+  return s_data;
+}
+
+// must be called with the lock held
+int find_job(const QList<SpriteDecodeJob> &p_queue, SpriteCacheEntry *p_entry)
+{
+  for (int i = 0; i < p_queue.length(); ++i)
+  {
+    if (p_queue.at(i).entry == p_entry)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// must be called with the lock held
+void record_queue_depth(SpriteDecodeSchedulerData &p_data)
+{
+  DR_PROFILE_COUNTER("decode queue visible", p_data.queue_list[int(SpriteDecodeScheduler::Priority::VisibleNow)].length());
+  DR_PROFILE_COUNTER("decode queue next message", p_data.queue_list[int(SpriteDecodeScheduler::Priority::NextMessage)].length());
+  DR_PROFILE_COUNTER("decode queue speculative", p_data.queue_list[int(SpriteDecodeScheduler::Priority::Speculative)].length());
+}
+} // namespace
+
+int SpriteDecodeScheduler::get_max_thread_count()
+{
+  return scheduler_data().pool.maxThreadCount();
+}
+
+void SpriteDecodeScheduler::set_max_thread_count(int p_count)
+{
+  scheduler_data().pool.setMaxThreadCount(qMax(1, p_count));
+}
+
+void SpriteDecodeScheduler::submit(SpriteCacheEntry *p_entry, SpriteMappedFile::ptr p_source, Priority p_priority)
+{
+  SpriteDecodeSchedulerData &l_data = scheduler_data();
+  {
+    QMutexLocker l_locker(&l_data.lock);
+    l_data.queue_list[int(p_priority)].append(SpriteDecodeJob{p_entry, p_source});
+    record_queue_depth(l_data);
+  }
+  // tasks pick the most urgent job when they run, not the one they were started for
+  l_data.pool.start(new SpriteDecodeTask);
+}
+
+void SpriteDecodeScheduler::set_priority(SpriteCacheEntry *p_entry, Priority p_priority)
+{
+  SpriteDecodeSchedulerData &l_data = scheduler_data();
+  QMutexLocker l_locker(&l_data.lock);
+  for (int i = 0; i < PriorityCount; ++i)
+  {
+    QList<SpriteDecodeJob> &l_queue = l_data.queue_list[i];
+    const int l_index = find_job(l_queue, p_entry);
+    if (l_index == -1)
+    {
+      continue;
+    }
+
+    if (i != int(p_priority))
+    {
+      l_data.queue_list[int(p_priority)].append(l_queue.takeAt(l_index));
+      record_queue_depth(l_data);
+    }
+    return;
+  }
+}
+
+void SpriteDecodeScheduler::cancel(SpriteCacheEntry *p_entry)
+{
+  SpriteDecodeSchedulerData &l_data = scheduler_data();
+  QMutexLocker l_locker(&l_data.lock);
+  for (QList<SpriteDecodeJob> &i_queue : l_data.queue_list)
+  {
+    const int l_index = find_job(i_queue, p_entry);
+    if (l_index != -1)
+    {
+      i_queue.removeAt(l_index);
+      record_queue_depth(l_data);
+      return;
+    }
+  }
+
+  while (l_data.running_entries.contains(p_entry))
+  {
+    l_data.finished.wait(&l_data.lock);
+  }
+}
+
+int SpriteDecodeScheduler::get_queue_depth(Priority p_priority)
+{
+  SpriteDecodeSchedulerData &l_data = scheduler_data();
+  QMutexLocker l_locker(&l_data.lock);
+  return l_data.queue_list[int(p_priority)].length();
+}
+
+int SpriteDecodeScheduler::get_total_queue_depth()
+{
+  SpriteDecodeSchedulerData &l_data = scheduler_data();
+  QMutexLocker l_locker(&l_data.lock);
+  int l_depth = 0;
+  for (const QList<SpriteDecodeJob> &i_queue : l_data.queue_list)
+  {
+    l_depth += i_queue.length();
+  }
+  return l_depth;
+}
+
+int SpriteDecodeScheduler::get_running_count()
+{
+  SpriteDecodeSchedulerData &l_data = scheduler_data();
+  QMutexLocker l_locker(&l_data.lock);
+  return l_data.running_entries.size();
+}
+
+void SpriteDecodeScheduler::_p_run_next()
+{
+  SpriteDecodeSchedulerData &l_data = scheduler_data();
+  SpriteDecodeJob l_job;
+  {
+    QMutexLocker l_locker(&l_data.lock);
+    for (QList<SpriteDecodeJob> &i_queue : l_data.queue_list)
+    {
+      if (!i_queue.isEmpty())
+      {
+        l_job = i_queue.takeFirst();
+        break;
+      }
+    }
+
+    // the job may have been cancelled since this task was started
+    if (l_job.entry == nullptr)
+    {
+      return;
+    }
+    l_data.running_entries.insert(l_job.entry);
+    record_queue_depth(l_data);
+    DR_PROFILE_COUNTER("decode running", l_data.running_entries.size());
+  }
+
+  // the entry cannot be destroyed while it is running, its destructor cancels the job first
+  l_job.entry->_p_decode(l_job.source);
+
+  QMutexLocker l_locker(&l_data.lock);
+  l_data.running_entries.remove(l_job.entry);
+  DR_PROFILE_COUNTER("decode running", l_data.running_entries.size());
+  l_data.finished.wakeAll();
+}
@@ -0,0 +1,68 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#pragma once
+
+#include "mk2/spritemappedfile.h"
+
+namespace mk2
+{
+class SpriteCacheEntry;
+
+/*!
+ * Dedicated worker pool decoding sprites for SpriteCacheEntry.
+ *
+ * Pending decodes are served by priority class, oldest first within a class,
+ * so that the sprite on screen never waits behind a speculative preload. The
+ * priority of a pending decode can change while it is queued.
+ */
+class SpriteDecodeScheduler
+{
+public:
+  enum class Priority
+  {
+    VisibleNow,
+    NextMessage,
+    Speculative,
+  };
+  static constexpr int PriorityCount = 3;
+
+  static int get_max_thread_count();
+  static void set_max_thread_count(int count);
+
+  static void submit(SpriteCacheEntry *entry, SpriteMappedFile::ptr source, Priority priority);
+
+  static void set_priority(SpriteCacheEntry *entry, Priority priority);
+
+  // removes the pending decode of the entry, or waits for it to finish when it already started
+  static void cancel(SpriteCacheEntry *entry);
+
+  static int get_queue_depth(Priority priority);
+  static int get_total_queue_depth();
+  static int get_running_count();
+
+private:
+  SpriteDecodeScheduler() = delete;
+
+  static void _p_run_next();
+
+  friend class SpriteDecodeTask;
+};
+} // namespace mk2
@@ -0,0 +1,458 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+
+#include "mk2/spritediskcache.h"
+
+#include "mk2/spritecache.h"
+#include "mk2/spritecacheentry.h"
+#include "mk2/spriteframecodec.h"
+#include "modules/debug/profiler.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtEndian>
+
+#include <atomic>
+
+namespace mk2
+{
+class SpriteWarmUpTask : public QRunnable
+{
+public:
+  SpriteWarmUpTask(QStringList p_root_list, int p_generation)
+      : m_root_list(p_root_list)
+      , m_generation(p_generation)
+  {}
+
+  void run() final;
+
+private:
+  QStringList m_root_list;
+  int m_generation;
+};
+} // namespace mk2
+
+using namespace mk2;
+
+namespace
+{
+const quint32 s_record_magic = 0x43535244; // "DRSC"
+const quint32 s_record_version = 1;
+const QString s_record_suffix = ".drsc";
+
+struct SpriteDiskCacheData
+{
+  QMutex lock;
+  QString directory;
+  qint64 byte_budget = 1024ll * 1024 * 1024;
+  qint64 disk_usage = 0;
+  // cache keys change with the source file, so a hash stays valid for as long as its key
+  QHash<QString, QByteArray> content_hash_map;
+  std::atomic_int warm_up_generation{0};
+  QThreadPool warm_up_pool;
+  QThreadPool hash_pool;
+
+  SpriteDiskCacheData()
+  {
+    warm_up_pool.setMaxThreadCount(1);
+    hash_pool.setMaxThreadCount(1);
+  }
+};
+
+SpriteDiskCacheData &disk_cache_data()
+{
+  static SpriteDiskCacheData s_data;
+  return s_data;
+}
+
+QString record_path(const QString &p_directory, const QString &p_cache_key)
+{
+  return QDir(p_directory).filePath(QString::fromLatin1(QCryptographicHash::hash(p_cache_key.toUtf8(), QCryptographicHash::Md5).toHex()) + s_record_suffix);
+}
+
+// returns an empty hash when the source was not hashed yet and may not be
+QByteArray content_hash(const QString &p_cache_key, const SpriteMappedFile::ptr &p_source, bool p_hash_source = true)
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  {
+    QMutexLocker l_locker(&l_data.lock);
+    const QByteArray l_hash = l_data.content_hash_map.value(p_cache_key);
+    if (!l_hash.isEmpty() || !p_hash_source)
+    {
+      return l_hash;
+    }
+  }
+
+  DR_PROFILE_SCOPE("SpriteDiskCache content hash");
+  const QByteArray l_hash = QCryptographicHash::hash(QByteArray::fromRawData(reinterpret_cast<const char *>(p_source->get_data()), int(p_source->get_size())), QCryptographicHash::Md5);
+  QMutexLocker l_locker(&l_data.lock);
+  l_data.content_hash_map.insert(p_cache_key, l_hash);
+  return l_hash;
+}
+
+// must be called with the lock held
+void prune_directory(SpriteDiskCacheData &p_data)
+{
+  if (p_data.directory.isEmpty())
+  {
+    p_data.disk_usage = 0;
+    return;
+  }
+
+  // records are touched whenever they are used, so the newest come first
+  const QFileInfoList l_record_list = QDir(p_data.directory).entryInfoList({"*" + s_record_suffix}, QDir::Files, QDir::Time);
+  qint64 l_disk_usage = 0;
+  for (const QFileInfo &i_record : l_record_list)
+  {
+    if (l_disk_usage + i_record.size() > p_data.byte_budget)
+    {
+      QFile::remove(i_record.filePath());
+      continue;
+    }
+    l_disk_usage += i_record.size();
+  }
+  p_data.disk_usage = l_disk_usage;
+  DR_PROFILE_COUNTER("sprite disk cache bytes", p_data.disk_usage);
+}
+} // namespace
+
+int SpriteDiskRecord::get_frame_count() const
+{
+  return delay_list.length();
+}
+
+SpriteFrame SpriteDiskRecord::get_frame(int p_number) const
+{
+  SpriteFrame l_frame;
+  if (p_number < 0 || p_number >= get_frame_count())
+  {
+    return l_frame;
+  }
+  l_frame.delay = delay_list.at(p_number);
+  l_frame.image = SpriteFrameCodec::decode(packed_frame_list.at(p_number), packed_frame_size);
+  if (crop_rect.isValid())
+  {
+    if (l_frame.image.size() != crop_rect.size())
+    {
+      l_frame.image = l_frame.image.copy(crop_rect);
+    }
+    l_frame.offset = crop_rect.topLeft();
+  }
+  return l_frame;
+}
+
+QString SpriteDiskCache::get_directory()
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  return l_data.directory;
+}
+
+void SpriteDiskCache::set_directory(QString p_directory)
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  if (l_data.directory == p_directory)
+  {
+    return;
+  }
+  l_data.directory = p_directory;
+  prune_directory(l_data);
+}
+
+qint64 SpriteDiskCache::get_byte_budget()
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  return l_data.byte_budget;
+}
+
+void SpriteDiskCache::set_byte_budget(qint64 p_bytes)
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  l_data.byte_budget = qMax(0ll, p_bytes);
+  prune_directory(l_data);
+}
+
+bool SpriteDiskCache::is_enabled()
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  return !l_data.directory.isEmpty() && l_data.byte_budget > 0;
+}
+
+qint64 SpriteDiskCache::get_disk_usage()
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  return l_data.disk_usage;
+}
+
+bool SpriteDiskCache::contains(QString p_cache_key)
+{
+  const QString l_directory = get_directory();
+  if (p_cache_key.isEmpty() || l_directory.isEmpty())
+  {
+    return false;
+  }
+  return QFileInfo::exists(record_path(l_directory, p_cache_key));
+}
+
+SpriteDiskRecord::ptr SpriteDiskCache::find(QString p_cache_key, SpriteMappedFile::ptr p_source, bool p_hash_source)
+{
+  if (!p_source || p_cache_key.isEmpty() || !is_enabled())
+  {
+    return nullptr;
+  }
+
+  const QString l_path = record_path(get_directory(), p_cache_key);
+  QFile l_file(l_path);
+  if (!l_file.exists() || !l_file.open(QIODevice::ReadOnly))
+  {
+    return nullptr;
+  }
+
+  DR_PROFILE_SCOPE("SpriteDiskCache find");
+  SpriteMappedFile::ptr l_mapping = SpriteMappedFile::open(&l_file);
+  if (!l_mapping || l_mapping->get_size() < qint64(sizeof(quint32)))
+  {
+    return nullptr;
+  }
+
+  const char *l_data = reinterpret_cast<const char *>(l_mapping->get_data());
+  const qint64 l_size = l_mapping->get_size();
+  const qint64 l_header_size = qFromLittleEndian<quint32>(l_data);
+  const qint64 l_data_start = qint64(sizeof(quint32)) + l_header_size;
+  if (l_data_start > l_size)
+  {
+    return nullptr;
+  }
+
+  QDataStream l_stream(QByteArray::fromRawData(l_data + sizeof(quint32), int(l_header_size)));
+  l_stream.setVersion(QDataStream::Qt_5_15);
+  l_stream.setByteOrder(QDataStream::LittleEndian);
+  quint32 l_magic = 0;
+  quint32 l_version = 0;
+  QByteArray l_content_hash;
+  l_stream >> l_magic >> l_version;
+  if (l_magic != s_record_magic || l_version != s_record_version)
+  {
+    return nullptr;
+  }
+  l_stream >> l_content_hash;
+  if (l_content_hash != content_hash(p_cache_key, p_source, p_hash_source))
+  {
+    return nullptr;
+  }
+
+  SpriteDiskRecord::ptr l_record(new SpriteDiskRecord);
+  qint32 l_frame_count = 0;
+  l_stream >> l_record->sprite_size >> l_record->loop_count >> l_record->packed_frame_size >> l_record->crop_rect >> l_frame_count;
+  if (l_stream.status() != QDataStream::Ok || l_frame_count <= 0)
+  {
+    return nullptr;
+  }
+
+  for (int i = 0; i < l_frame_count; ++i)
+  {
+    qint32 l_delay = 0;
+    quint64 l_offset = 0;
+    quint32 l_length = 0;
+    l_stream >> l_delay >> l_offset >> l_length;
+    if (l_stream.status() != QDataStream::Ok || l_offset + l_length > quint64(l_size - l_data_start))
+    {
+      return nullptr;
+    }
+    l_record->delay_list.append(l_delay);
+    l_record->packed_frame_list.append(QByteArray::fromRawData(l_data + l_data_start + l_offset, int(l_length)));
+  }
+  l_record->m_file = l_mapping;
+
+  // keep recently used records at the front of the pruning order
+  QFile l_touch_file(l_path);
+  if (l_touch_file.open(QIODevice::ReadWrite))
+  {
+    l_touch_file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+  }
+  return l_record;
+}
+
+void SpriteDiskCache::prepare(QString p_cache_key, SpriteMappedFile::ptr p_source)
+{
+  if (!p_source || !contains(p_cache_key))
+  {
+    return;
+  }
+  disk_cache_data().hash_pool.start([p_cache_key, p_source]() { content_hash(p_cache_key, p_source); });
+}
+
+bool SpriteDiskCache::store(QString p_cache_key, SpriteMappedFile::ptr p_source, const SpriteDiskRecord &p_record, bool p_evict)
+{
+  if (!p_source || p_cache_key.isEmpty() || !is_enabled() || p_record.get_frame_count() != p_record.packed_frame_list.length())
+  {
+    return false;
+  }
+
+  DR_PROFILE_SCOPE("SpriteDiskCache store");
+  const QString l_directory = get_directory();
+  if (!QDir().mkpath(l_directory))
+  {
+    return false;
+  }
+
+  QByteArray l_header;
+  QDataStream l_stream(&l_header, QIODevice::WriteOnly);
+  l_stream.setVersion(QDataStream::Qt_5_15);
+  l_stream.setByteOrder(QDataStream::LittleEndian);
+  l_stream << s_record_magic << s_record_version << content_hash(p_cache_key, p_source);
+  l_stream << p_record.sprite_size << qint32(p_record.loop_count) << p_record.packed_frame_size << p_record.crop_rect << qint32(p_record.get_frame_count());
+
+  // shared frames are written once
+  QHash<const char *, quint64> l_offset_map;
+  QVector<QByteArray> l_data_list;
+  quint64 l_data_size = 0;
+  for (int i = 0; i < p_record.get_frame_count(); ++i)
+  {
+    const QByteArray &l_packed_frame = p_record.packed_frame_list.at(i);
+    quint64 l_offset = l_offset_map.value(l_packed_frame.constData(), l_data_size);
+    if (l_offset == l_data_size)
+    {
+      l_offset_map.insert(l_packed_frame.constData(), l_offset);
+      l_data_list.append(l_packed_frame);
+      l_data_size += quint64(l_packed_frame.size());
+    }
+    l_stream << qint32(p_record.delay_list.at(i)) << l_offset << quint32(l_packed_frame.size());
+  }
+
+  const quint32 l_header_size = qToLittleEndian(quint32(l_header.size()));
+  const qint64 l_record_size = qint64(sizeof(l_header_size)) + l_header.size() + qint64(l_data_size);
+  if (!p_evict && l_record_size > get_byte_budget() - get_disk_usage())
+  {
+    return false;
+  }
+
+  // written under a temporary name, so readers never see a partial record
+  QSaveFile l_file(record_path(l_directory, p_cache_key));
+  if (!l_file.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+  l_file.write(reinterpret_cast<const char *>(&l_header_size), sizeof(l_header_size));
+  l_file.write(l_header);
+  for (const QByteArray &i_data : qAsConst(l_data_list))
+  {
+    l_file.write(i_data);
+  }
+  if (!l_file.commit())
+  {
+    return false;
+  }
+
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  l_data.disk_usage += l_record_size;
+  if (l_data.disk_usage > l_data.byte_budget)
+  {
+    prune_directory(l_data);
+  }
+  DR_PROFILE_COUNTER("sprite disk cache bytes", l_data.disk_usage);
+  return true;
+}
+
+void SpriteDiskCache::prune()
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  QMutexLocker l_locker(&l_data.lock);
+  prune_directory(l_data);
+}
+
+void SpriteDiskCache::warm_up(QStringList p_root_list)
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  const int l_generation = ++l_data.warm_up_generation;
+  if (!is_enabled())
+  {
+    return;
+  }
+  l_data.warm_up_pool.start(new SpriteWarmUpTask(p_root_list, l_generation));
+}
+
+void SpriteDiskCache::stop_warm_up()
+{
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  ++l_data.warm_up_generation;
+  l_data.warm_up_pool.waitForDone();
+}
+
+void SpriteWarmUpTask::run()
+{
+  DR_PROFILE_SCOPE("SpriteDiskCache warm up");
+  SpriteDiskCacheData &l_data = disk_cache_data();
+  // never compete with the decodes a reader is waiting for
+  QThread::currentThread()->setPriority(QThread::LowestPriority);
+
+  // character sprites are what the first message of each speaker waits for
+  const QStringList l_filter_list{"*.webp", "*.apng", "*.gif"};
+  for (const QString &i_root : qAsConst(m_root_list))
+  {
+    QDirIterator l_iterator(QDir(i_root).filePath("characters"), l_filter_list, QDir::Files, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    while (l_iterator.hasNext())
+    {
+      const QString l_file_name = l_iterator.next();
+      if (l_data.warm_up_generation != m_generation || !SpriteDiskCache::is_enabled() || SpriteDiskCache::get_disk_usage() >= SpriteDiskCache::get_byte_budget())
+      {
+        return;
+      }
+
+      const QString l_cache_key = SpriteCache::get_cache_key(l_file_name);
+      if (l_cache_key.isEmpty() || SpriteDiskCache::contains(l_cache_key))
+      {
+        continue;
+      }
+
+      QFile l_file(l_file_name);
+      const SpriteMappedFile::ptr l_source = SpriteMappedFile::open(&l_file);
+      if (!l_source)
+      {
+        continue;
+      }
+      // animations are stored without eviction, so a missing record means the budget is used up
+      SpriteCacheEntry l_entry(l_cache_key);
+      if (l_entry.decode(l_source) && l_entry.get_frame_count() > 1 && !SpriteDiskCache::contains(l_cache_key))
+      {
+        return;
+      }
+    }
+  }
+}
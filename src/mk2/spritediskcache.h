@@ -0,0 +1,110 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+
+#pragma once
+
+#include "mk2/spritemappedfile.h"
+#include "mk2/spritereader.h"
+
+#include <QByteArray>
+#include <QRect>
+#include <QSharedPointer>
+#include <QSize>
+#include <QStringList>
+#include <QVector>
+
+namespace mk2
+{
+/*!
+ * Frames of a sprite file as kept by the disk cache.
+ *
+ * Frames are stored with SpriteFrameCodec at packed_frame_size. When
+ * crop_rect is valid, they cover only that part of the canvas, either
+ * already cut to it or to be cut once expanded. Records read from disk hold
+ * views into the mapped cache file and keep it mapped while they exist.
+ */
+class SpriteDiskRecord
+{
+public:
+  using ptr = QSharedPointer<SpriteDiskRecord>;
+
+  QSize sprite_size;
+  int loop_count = 0;
+  QSize packed_frame_size;
+  QRect crop_rect;
+  QVector<int> delay_list;
+  QVector<QByteArray> packed_frame_list;
+
+  int get_frame_count() const;
+
+  SpriteFrame get_frame(int number) const;
+
+private:
+  SpriteMappedFile::ptr m_file;
+
+  friend class SpriteDiskCache;
+};
+
+/*!
+ * Persistent cache of transcoded sprite animations.
+ *
+ * Records are found by the sprite cache key of their source file and checked
+ * against a hash of its contents before use. The directory is kept within
+ * the byte budget by removing the least recently used records, and can be
+ * filled ahead of time by a background warm-up pass.
+ */
+class SpriteDiskCache
+{
+public:
+  // an empty directory or a zero budget disables the cache
+  static QString get_directory();
+  static void set_directory(QString directory);
+
+  static qint64 get_byte_budget();
+  static void set_byte_budget(qint64 bytes);
+
+  static bool is_enabled();
+
+  static qint64 get_disk_usage();
+
+  static bool contains(QString cache_key);
+
+  // returns null on a miss or when the record was made from different contents; the source is hashed once per cache
+  // key, and without hashing only sources hashed before are found
+  static SpriteDiskRecord::ptr find(QString cache_key, SpriteMappedFile::ptr source, bool hash_source = true);
+
+  // without eviction, a record that does not fit within the byte budget is not stored; returns whether it was stored
+  // hashes the source in the background when it has a record, so a later lookup without hashing can find it
+  static void prepare(QString cache_key, SpriteMappedFile::ptr source);
+
+  static bool store(QString cache_key, SpriteMappedFile::ptr source, const SpriteDiskRecord &record, bool evict = true);
+
+  static void prune();
+
+  // transcodes animations below the given roots that are not cached yet, until the next record no longer fits
+  // within the byte budget; never evicts a record. a new pass replaces the running one
+  static void warm_up(QStringList root_list);
+  static void stop_warm_up();
+
+private:
+  SpriteDiskCache() = delete;
+};
+} // namespace mk2
@@ -32,12 +32,13 @@ class SpriteDynamicReader : public SpriteReader
   Q_OBJECT
 
 public:
-  static int get_system_memory_threshold();
-  static void set_system_memory_threshold(int percent);
-
   explicit SpriteDynamicReader(QObject *parent = nullptr);
   virtual ~SpriteDynamicReader();
 
+  bool is_caching() const final;
+
+  qint64 get_mapped_bytes() const final;
+
   QSize get_sprite_size() const final;
 
   int get_frame_count() const final;
@@ -46,14 +47,16 @@ public:
 
   QVector<SpriteFrame> get_frame_list() final;
 
+  bool can_play_through(int preroll_frames) const final;
+
+  void set_decode_priority(SpriteDecodeScheduler::Priority priority) final;
+
 protected:
   void load() final;
 
 private:
   QSharedPointer<SpriteReader> m_reader;
-  std::atomic_uint64_t m_used_memory;
 
   void _p_create_reader(bool caching);
-  void _p_free_memory();
 };
 } // namespace mk2
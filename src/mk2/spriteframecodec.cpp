@@ -0,0 +1,238 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+
+#include "mk2/spriteframecodec.h"
+
+#include "modules/debug/profiler.h"
+
+using namespace mk2;
+
+namespace
+{
+enum : uchar
+{
+  OP_INDEX = 0x00,
+  OP_DIFF = 0x40,
+  OP_LUMA = 0x80,
+  OP_RUN = 0xc0,
+  OP_RGB = 0xfe,
+  OP_RGBA = 0xff,
+  OP_MASK = 0xc0,
+};
+
+constexpr int s_max_run_length = 62;
+constexpr int s_color_table_size = 64;
+
+inline int color_hash(QRgb p_color)
+{
+  return (qRed(p_color) * 3 + qGreen(p_color) * 5 + qBlue(p_color) * 7 + qAlpha(p_color) * 11) % s_color_table_size;
+}
+} // namespace
+
+QByteArray SpriteFrameCodec::encode(const QImage &p_image)
+{
+  DR_PROFILE_SCOPE("SpriteFrameCodec encode");
+  const QImage l_image = p_image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+  const int l_width = l_image.width();
+  const int l_height = l_image.height();
+  if (l_width <= 0 || l_height <= 0)
+  {
+    return QByteArray{};
+  }
+
+  // worst case is a full RGBA op for every pixel
+  QByteArray l_data;
+  l_data.resize(l_width * l_height * 5);
+  uchar *l_out = reinterpret_cast<uchar *>(l_data.data());
+  int l_length = 0;
+
+  QRgb l_color_table[s_color_table_size] = {};
+  QRgb l_previous = qRgba(0, 0, 0, 255);
+  int l_run = 0;
+  for (int y = 0; y < l_height; ++y)
+  {
+    const QRgb *l_line = reinterpret_cast<const QRgb *>(l_image.constScanLine(y));
+    for (int x = 0; x < l_width; ++x)
+    {
+      const QRgb l_pixel = l_line[x];
+      if (l_pixel == l_previous)
+      {
+        ++l_run;
+        if (l_run == s_max_run_length)
+        {
+          l_out[l_length++] = OP_RUN | (l_run - 1);
+          l_run = 0;
+        }
+        continue;
+      }
+
+      if (l_run > 0)
+      {
+        l_out[l_length++] = OP_RUN | (l_run - 1);
+        l_run = 0;
+      }
+
+      const int l_hash = color_hash(l_pixel);
+      if (l_color_table[l_hash] == l_pixel)
+      {
+        l_out[l_length++] = OP_INDEX | l_hash;
+      }
+      else
+      {
+        l_color_table[l_hash] = l_pixel;
+        if (qAlpha(l_pixel) == qAlpha(l_previous))
+        {
+          const signed char l_dr = qRed(l_pixel) - qRed(l_previous);
+          const signed char l_dg = qGreen(l_pixel) - qGreen(l_previous);
+          const signed char l_db = qBlue(l_pixel) - qBlue(l_previous);
+          const signed char l_dr_dg = l_dr - l_dg;
+          const signed char l_db_dg = l_db - l_dg;
+
+          if (l_dr >= -2 && l_dr <= 1 && l_dg >= -2 && l_dg <= 1 && l_db >= -2 && l_db <= 1)
+          {
+            l_out[l_length++] = OP_DIFF | (l_dr + 2) << 4 | (l_dg + 2) << 2 | (l_db + 2);
+          }
+          else if (l_dg >= -32 && l_dg <= 31 && l_dr_dg >= -8 && l_dr_dg <= 7 && l_db_dg >= -8 && l_db_dg <= 7)
+          {
+            l_out[l_length++] = OP_LUMA | (l_dg + 32);
+            l_out[l_length++] = (l_dr_dg + 8) << 4 | (l_db_dg + 8);
+          }
+          else
+          {
+            l_out[l_length++] = OP_RGB;
+            l_out[l_length++] = qRed(l_pixel);
+            l_out[l_length++] = qGreen(l_pixel);
+            l_out[l_length++] = qBlue(l_pixel);
+          }
+        }
+        else
+        {
+          l_out[l_length++] = OP_RGBA;
+          l_out[l_length++] = qRed(l_pixel);
+          l_out[l_length++] = qGreen(l_pixel);
+          l_out[l_length++] = qBlue(l_pixel);
+          l_out[l_length++] = qAlpha(l_pixel);
+        }
+      }
+      l_previous = l_pixel;
+    }
+  }
+
+  if (l_run > 0)
+  {
+    l_out[l_length++] = OP_RUN | (l_run - 1);
+  }
+
+  l_data.resize(l_length);
+  l_data.squeeze();
+  return l_data;
+}
+
+QImage SpriteFrameCodec::decode(const QByteArray &p_data, QSize p_size)
+{
+  DR_PROFILE_SCOPE("SpriteFrameCodec decode");
+  if (p_size.isEmpty())
+  {
+    return QImage{};
+  }
+
+  QImage l_image(p_size, QImage::Format_ARGB32_Premultiplied);
+  if (l_image.isNull())
+  {
+    return QImage{};
+  }
+
+  const uchar *l_in = reinterpret_cast<const uchar *>(p_data.constData());
+  const int l_length = p_data.length();
+  int l_position = 0;
+
+  QRgb l_color_table[s_color_table_size] = {};
+  QRgb l_pixel = qRgba(0, 0, 0, 255);
+  int l_run = 0;
+  for (int y = 0; y < p_size.height(); ++y)
+  {
+    QRgb *l_line = reinterpret_cast<QRgb *>(l_image.scanLine(y));
+    for (int x = 0; x < p_size.width(); ++x)
+    {
+      if (l_run > 0)
+      {
+        --l_run;
+        l_line[x] = l_pixel;
+        continue;
+      }
+
+      if (l_position >= l_length)
+      {
+        return QImage{};
+      }
+
+      const uchar l_op = l_in[l_position++];
+      if (l_op == OP_RGB)
+      {
+        if (l_length - l_position < 3)
+        {
+          return QImage{};
+        }
+        l_pixel = qRgba(l_in[l_position], l_in[l_position + 1], l_in[l_position + 2], qAlpha(l_pixel));
+        l_position += 3;
+      }
+      else if (l_op == OP_RGBA)
+      {
+        if (l_length - l_position < 4)
+        {
+          return QImage{};
+        }
+        l_pixel = qRgba(l_in[l_position], l_in[l_position + 1], l_in[l_position + 2], l_in[l_position + 3]);
+        l_position += 4;
+      }
+      else
+      {
+        switch (l_op & OP_MASK)
+        {
+        case OP_INDEX:
+          l_pixel = l_color_table[l_op];
+          break;
+        case OP_DIFF:
+          l_pixel = qRgba((qRed(l_pixel) + ((l_op >> 4) & 0x03) - 2) & 0xff, (qGreen(l_pixel) + ((l_op >> 2) & 0x03) - 2) & 0xff, (qBlue(l_pixel) + (l_op & 0x03) - 2) & 0xff, qAlpha(l_pixel));
+          break;
+        case OP_LUMA:
+        {
+          if (l_position >= l_length)
+          {
+            return QImage{};
+          }
+          const uchar l_next = l_in[l_position++];
+          const int l_dg = (l_op & 0x3f) - 32;
+          l_pixel = qRgba((qRed(l_pixel) + l_dg - 8 + ((l_next >> 4) & 0x0f)) & 0xff, (qGreen(l_pixel) + l_dg) & 0xff, (qBlue(l_pixel) + l_dg - 8 + (l_next & 0x0f)) & 0xff, qAlpha(l_pixel));
+          break;
+        }
+        case OP_RUN:
+          l_run = l_op & 0x3f;
+          break;
+        }
+      }
+
+      l_color_table[color_hash(l_pixel)] = l_pixel;
+      l_line[x] = l_pixel;
+    }
+  }
+  return l_image;
+}
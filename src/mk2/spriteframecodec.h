@@ -0,0 +1,50 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+
+namespace mk2
+{
+/*!
+ * Lossless compression for decoded sprite frames.
+ *
+ * The format follows QOI: pixels are encoded as runs, references into a small
+ * table of recently seen colors or small differences to the previous pixel.
+ * It compresses the flat areas and transparent borders typical of sprites
+ * well while decoding an order of magnitude faster than the source formats.
+ */
+class SpriteFrameCodec
+{
+public:
+  // pixels are stored premultiplied
+  static QByteArray encode(const QImage &image);
+
+  // returns a null image when the data does not describe an image of the given size,
+  // otherwise a Format_ARGB32_Premultiplied image
+  static QImage decode(const QByteArray &data, QSize size);
+
+private:
+  SpriteFrameCodec() = delete;
+};
+} // namespace mk2
@@ -0,0 +1,204 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#include "mk2/spritemappedfile.h"
+
+#include "mk2/spritecache.h"
+#include "modules/debug/profiler.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+#include <atomic>
+#include <cstring>
+
+using namespace mk2;
+
+namespace
+{
+struct SpriteMappedFileData
+{
+  QMutex lock;
+  // live mappings by cache key, so that readers of the same file share one
+  QHash<QString, QWeakPointer<SpriteMappedFile>> file_map;
+};
+
+SpriteMappedFileData &mapped_file_data()
+{
+  static SpriteMappedFileData s_data;
+  return s_data;
+}
+
+std::atomic_int s_mapping_count = 0;
+std::atomic<qint64> s_mapped_bytes = 0;
+} // namespace
+
+int SpriteMappedFile::get_mapping_count()
+{
+  return s_mapping_count;
+}
+
+qint64 SpriteMappedFile::get_mapped_bytes()
+{
+  return s_mapped_bytes;
+}
+
+SpriteMappedFile::ptr SpriteMappedFile::open(QIODevice *p_device)
+{
+  if (p_device == nullptr)
+  {
+    return nullptr;
+  }
+
+  QFile *l_device_file = qobject_cast<QFile *>(p_device);
+  const QString l_key = l_device_file ? SpriteCache::get_cache_key(l_device_file->fileName()) : QString{};
+  SpriteMappedFileData &l_data = mapped_file_data();
+  QMutexLocker l_locker(&l_data.lock);
+  if (!l_key.isEmpty())
+  {
+    if (ptr l_file = l_data.file_map.value(l_key).toStrongRef())
+    {
+      return l_file;
+    }
+
+    ptr l_file(new SpriteMappedFile);
+    l_file->m_key = l_key;
+    l_file->m_file.setFileName(l_device_file->fileName());
+    if (l_file->m_file.open(QIODevice::ReadOnly))
+    {
+      l_file->m_size = l_file->m_file.size();
+      l_file->m_data = l_file->m_file.map(0, l_file->m_size);
+      if (l_file->m_data != nullptr)
+      {
+        l_file->m_mapped = true;
+        ++s_mapping_count;
+        s_mapped_bytes += l_file->m_size;
+        DR_PROFILE_COUNTER("sprite mappings", s_mapping_count);
+        DR_PROFILE_COUNTER("sprite mapped bytes", s_mapped_bytes);
+        l_data.file_map.insert(l_key, l_file.toWeakRef());
+        return l_file;
+      }
+    }
+  }
+
+  l_locker.unlock();
+
+  // not a plain file, or the file could not be mapped
+  const qint64 l_prev_pos = p_device->pos();
+  if (!p_device->isOpen() && !p_device->open(QIODevice::ReadOnly))
+  {
+    return nullptr;
+  }
+  p_device->seek(0);
+  ptr l_file(new SpriteMappedFile);
+  l_file->m_buffer = p_device->readAll();
+  l_file->m_data = reinterpret_cast<const uchar *>(l_file->m_buffer.constData());
+  l_file->m_size = l_file->m_buffer.size();
+  p_device->seek(l_prev_pos);
+  return l_file;
+}
+
+SpriteMappedFile::~SpriteMappedFile()
+{
+  if (m_mapped)
+  {
+    SpriteMappedFileData &l_data = mapped_file_data();
+    {
+      QMutexLocker l_locker(&l_data.lock);
+      // the file may have been mapped again in the meantime
+      if (l_data.file_map.value(m_key).isNull())
+      {
+        l_data.file_map.remove(m_key);
+      }
+    }
+    m_file.unmap(const_cast<uchar *>(m_data));
+    --s_mapping_count;
+    s_mapped_bytes -= m_size;
+    DR_PROFILE_COUNTER("sprite mappings", s_mapping_count);
+    DR_PROFILE_COUNTER("sprite mapped bytes", s_mapped_bytes);
+  }
+}
+
+const uchar *SpriteMappedFile::get_data() const
+{
+  return m_data;
+}
+
+qint64 SpriteMappedFile::get_size() const
+{
+  return m_size;
+}
+
+bool SpriteMappedFile::is_mapped() const
+{
+  return m_mapped;
+}
+
+SpriteMappedDevice::SpriteMappedDevice(SpriteMappedFile::ptr p_file, QObject *parent)
+    : QIODevice{parent}
+    , m_file{p_file}
+{}
+
+SpriteMappedDevice::SpriteMappedDevice(SpriteMappedFile::ptr p_file, QByteArray p_prefix, qint64 p_offset, QObject *parent)
+    : QIODevice{parent}
+    , m_file{p_file}
+    , m_prefix{p_prefix}
+    , m_offset{m_file ? qBound(0ll, p_offset, m_file->get_size()) : 0}
+{}
+
+SpriteMappedFile::ptr SpriteMappedDevice::get_mapped_file() const
+{
+  return m_file;
+}
+
+bool SpriteMappedDevice::isSequential() const
+{
+  return false;
+}
+
+qint64 SpriteMappedDevice::size() const
+{
+  return m_prefix.size() + (m_file ? m_file->get_size() - m_offset : 0);
+}
+
+qint64 SpriteMappedDevice::readData(char *p_data, qint64 p_max_size)
+{
+  const qint64 l_size = qBound(0ll, size() - pos(), p_max_size);
+  qint64 l_read_size = 0;
+  if (pos() < m_prefix.size())
+  {
+    l_read_size = qMin(l_size, m_prefix.size() - pos());
+    std::memcpy(p_data, m_prefix.constData() + pos(), l_read_size);
+  }
+  if (l_size > l_read_size)
+  {
+    std::memcpy(p_data + l_read_size, m_file->get_data() + m_offset + pos() + l_read_size - m_prefix.size(), l_size - l_read_size);
+  }
+  return l_size;
+}
+
+qint64 SpriteMappedDevice::writeData(const char *p_data, qint64 p_max_size)
+{
+  Q_UNUSED(p_data);
+  Q_UNUSED(p_max_size);
+  return -1;
+}
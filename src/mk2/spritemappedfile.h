@@ -0,0 +1,97 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QIODevice>
+#include <QSharedPointer>
+
+namespace mk2
+{
+/*!
+ * Read-only view of a sprite file, shared by every reader of that file.
+ *
+ * The file is memory-mapped so that decoders read straight from the page
+ * cache. Devices that cannot be mapped are read into memory once instead.
+ */
+class SpriteMappedFile
+{
+public:
+  using ptr = QSharedPointer<SpriteMappedFile>;
+
+  static int get_mapping_count();
+  static qint64 get_mapped_bytes();
+
+  // returns null when the device cannot be opened
+  static ptr open(QIODevice *device);
+
+  ~SpriteMappedFile();
+
+  const uchar *get_data() const;
+
+  qint64 get_size() const;
+
+  bool is_mapped() const;
+
+private:
+  SpriteMappedFile() = default;
+  SpriteMappedFile(const SpriteMappedFile &) = delete;
+
+  QString m_key;
+  QFile m_file;
+  const uchar *m_data = nullptr;
+  qint64 m_size = 0;
+  bool m_mapped = false;
+  QByteArray m_buffer;
+};
+
+/*!
+ * Sequential reads over a SpriteMappedFile without copying it first.
+ *
+ * A device may also start from an offset within the file, behind a prefix of
+ * its own; a stream can then be picked up mid-file behind its header.
+ */
+class SpriteMappedDevice : public QIODevice
+{
+  Q_OBJECT
+
+public:
+  explicit SpriteMappedDevice(SpriteMappedFile::ptr file, QObject *parent = nullptr);
+  SpriteMappedDevice(SpriteMappedFile::ptr file, QByteArray prefix, qint64 offset, QObject *parent = nullptr);
+
+  SpriteMappedFile::ptr get_mapped_file() const;
+
+  bool isSequential() const final;
+
+  qint64 size() const final;
+
+protected:
+  qint64 readData(char *data, qint64 max_size) final;
+
+  qint64 writeData(const char *data, qint64 max_size) final;
+
+private:
+  SpriteMappedFile::ptr m_file;
+  QByteArray m_prefix;
+  qint64 m_offset = 0;
+};
+} // namespace mk2
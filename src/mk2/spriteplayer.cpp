@@ -19,16 +19,34 @@
 **************************************************************************/
 
 #include "mk2/spritedynamicreader.h"
+#include "mk2/spriteticker.h"
 #include "mk2/spriteviewer.h"
+#include "modules/debug/profiler.h"
+#include "modules/managers/memory_manager.h"
 
 #include <QFile>
 #include <QResizeEvent>
 
 using namespace mk2;
 
+namespace
+{
+int transform_memory_consumer()
+{
+  static const int s_consumer = MemoryManager::get().RegisterConsumer("sprite transforms", MemoryManager::Priority::Cached);
+  return s_consumer;
+}
+
+// players live on the main thread only
+qint64 s_total_dropped_frame_count = 0;
+qint64 s_total_late_frame_count = 0;
+} // namespace
+
 SpritePlayer::SpritePlayer(QObject *parent)
     : QObject{parent}
     , m_reader{new SpriteDynamicReader}
+    , m_current_frame_number{-1}
+    , m_transformed_memory{0}
     , m_scaling_mode{StretchScaling}
     , m_resolved_scaling_mode{StretchScaling}
     , m_transform{Qt::SmoothTransformation}
@@ -37,25 +55,32 @@ SpritePlayer::SpritePlayer(QObject *parent)
     , m_play_once{false}
     , m_frame_count{0}
     , m_frame_number{0}
+    , m_next_frame_time{0}
+    , m_dropped_frame_count{0}
+    , m_late_frame_count{0}
 {
-  m_frame_timer.setTimerType(Qt::PreciseTimer);
-  m_frame_timer.setSingleShot(true);
-
   m_repaint_timer.setInterval(200);
   m_repaint_timer.setSingleShot(true);
 
-  connect(&m_frame_timer, SIGNAL(timeout()), this, SLOT(fetch_next_frame()));
   connect(&m_repaint_timer, SIGNAL(timeout()), this, SLOT(scale_current_frame()));
 }
 
 SpritePlayer::~SpritePlayer()
-{}
+{
+  SpriteTicker::unsubscribe(this);
+  release_transformed_frames();
+}
 
 QImage SpritePlayer::get_current_frame() const
 {
   return m_scaled_current_frame;
 }
 
+QPoint SpritePlayer::get_current_frame_offset() const
+{
+  return m_scaled_current_offset;
+}
+
 QImage SpritePlayer::get_current_native_frame() const
 {
   return m_current_frame.image;
@@ -63,7 +88,11 @@ QImage SpritePlayer::get_current_native_frame() const
 
 QRectF SpritePlayer::get_scaled_bounding_rect() const
 {
-  return m_scaled_current_frame.rect();
+  if (m_scaled_current_frame.isNull())
+  {
+    return QRectF{};
+  }
+  return QRectF(QPointF(0, 0), QSizeF(m_scaled_canvas_size));
 }
 
 QString SpritePlayer::get_file_name() const
@@ -93,6 +122,7 @@ void SpritePlayer::set_file_name(QString p_file_name)
     return;
   }
   stop();
+  clear_transformed_frames();
   m_reader->set_file_name(p_file_name);
   m_frame_count = m_reader->get_frame_count();
   emit file_name_changed(p_file_name);
@@ -102,6 +132,7 @@ void SpritePlayer::set_device(QIODevice *p_device)
 {
   const QString l_prev_file_name = get_file_name();
   stop();
+  clear_transformed_frames();
   m_reader->set_device(p_device);
   m_frame_count = m_reader->get_frame_count();
   const QString l_file_name = get_file_name();
@@ -158,6 +189,7 @@ void SpritePlayer::set_reader(SpriteReader::ptr p_reader)
     p_reader = SpriteReader::ptr(new SpriteDynamicReader);
   }
   m_reader = p_reader;
+  clear_transformed_frames();
   m_frame_count = m_reader->get_frame_count();
   const QString l_file_name = get_file_name();
   if (l_file_name != l_prev_file_name)
@@ -180,6 +212,7 @@ void SpritePlayer::start()
 {
   m_running = true;
   m_elapsed_timer.start();
+  m_next_frame_time = SpriteTicker::get_time();
   emit started();
   resolve_scaling_mode();
   fetch_next_frame();
@@ -194,7 +227,7 @@ void SpritePlayer::restart()
 void SpritePlayer::stop()
 {
   m_running = false;
-  m_frame_timer.stop();
+  SpriteTicker::unsubscribe(this);
   m_frame_number = 0;
 }
 
@@ -210,6 +243,7 @@ void SpritePlayer::start(int p_start_frame)
   }
   m_running = true;
   m_elapsed_timer.start();
+  m_next_frame_time = SpriteTicker::get_time();
   emit started();
   resolve_scaling_mode();
   fetch_next_frame();
@@ -226,6 +260,32 @@ int SpritePlayer::get_frame()
   return m_frame_number;
 }
 
+int SpritePlayer::get_dropped_frame_count() const
+{
+  return m_dropped_frame_count;
+}
+
+int SpritePlayer::get_late_frame_count() const
+{
+  return m_late_frame_count;
+}
+
+qint64 SpritePlayer::get_total_dropped_frame_count()
+{
+  return s_total_dropped_frame_count;
+}
+
+qint64 SpritePlayer::get_total_late_frame_count()
+{
+  return s_total_late_frame_count;
+}
+
+void SpritePlayer::reset_frame_statistics()
+{
+  m_dropped_frame_count = 0;
+  m_late_frame_count = 0;
+}
+
 void SpritePlayer::resolve_scaling_mode()
 {
   m_resolved_scaling_mode = m_scaling_mode;
@@ -272,8 +332,8 @@ void SpritePlayer::resolve_scaling_mode()
 
 void SpritePlayer::fetch_next_frame()
 {
-  QElapsedTimer l_timer;
-  l_timer.start();
+  // subscribed again below as long as another frame is due
+  SpriteTicker::unsubscribe(this);
 
   if (!is_valid())
   {
@@ -310,14 +370,50 @@ void SpritePlayer::fetch_next_frame()
     }
   }
 
-  const int l_current_frame_number = m_frame_number;
-  m_current_frame = m_reader->get_frame(l_current_frame_number);
-  m_frame_number++;
+  const qint64 l_time = SpriteTicker::get_time();
+  int l_current_frame_number = m_frame_number;
+  SpriteFrame l_frame = m_reader->get_frame(l_current_frame_number);
+  if (SpriteTicker::is_frame_dropping_enabled())
+  {
+    // skip every frame whose display time has passed entirely; frames are still read in order since
+    // seeking readers decode sequentially, but they are never scaled
+    // a single play always ends on its last frame, and a loop is never skipped more than once around
+    int l_dropped_frame_count = 0;
+    while (l_dropped_frame_count + 1 < m_frame_count && m_next_frame_time + l_frame.delay <= l_time)
+    {
+      const int l_next_frame_number = (l_current_frame_number + 1) % m_frame_count;
+      if (m_play_once && l_next_frame_number == 0)
+      {
+        break;
+      }
+      m_next_frame_time += l_frame.delay;
+      l_current_frame_number = l_next_frame_number;
+      l_frame = m_reader->get_frame(l_current_frame_number);
+      ++l_dropped_frame_count;
+    }
+
+    if (l_dropped_frame_count > 0)
+    {
+      m_dropped_frame_count += l_dropped_frame_count;
+      s_total_dropped_frame_count += l_dropped_frame_count;
+      DR_PROFILE_COUNTER("sprite frames dropped", s_total_dropped_frame_count);
+    }
+  }
+
+  if (l_time - m_next_frame_time > SpriteTicker::get_interval())
+  {
+    ++m_late_frame_count;
+    ++s_total_late_frame_count;
+    DR_PROFILE_COUNTER("sprite frames late", s_total_late_frame_count);
+  }
+
+  m_current_frame = l_frame;
+  m_current_frame_number = l_current_frame_number;
+  m_frame_number = l_current_frame_number + 1;
 
   scale_current_frame();
 
-  const int l_next_delay = qMax(0, int(m_current_frame.delay - l_timer.elapsed()));
-  if (l_next_delay == 0 && m_frame_count == 1)
+  if (m_current_frame.delay <= 0 && m_frame_count == 1)
   {
     m_running = false;
 
@@ -328,43 +424,157 @@ void SpritePlayer::fetch_next_frame()
   }
   else
   {
-    m_frame_timer.start(l_next_delay);
+    // deadlines follow on from one another so that tick rounding never accumulates; without frame
+    // dropping, a tick later than a whole frame delays the animation from then on
+    m_next_frame_time = qMax(m_next_frame_time + m_current_frame.delay, SpriteTicker::get_time());
+    SpriteTicker::subscribe(this);
+  }
+}
+
+bool SpritePlayer::TransformKey::operator==(const TransformKey &p_other) const
+{
+  return size == p_other.size && scaling_mode == p_other.scaling_mode && transform == p_other.transform && mirror == p_other.mirror;
+}
+
+QSize SpritePlayer::resolve_scaled_canvas_size() const
+{
+  const QSize l_sprite_size = m_reader->get_sprite_size();
+  if (!l_sprite_size.isValid())
+  {
+    return m_current_frame.image.size();
+  }
+
+  switch (m_resolved_scaling_mode)
+  {
+  case NoScaling:
+    [[fallthrough]];
+  default:
+    return l_sprite_size;
+
+  case StretchScaling:
+    return m_size;
+
+  case WidthScaling:
+    return QSize(m_size.width(), qRound(qreal(l_sprite_size.height()) * m_size.width() / qMax(l_sprite_size.width(), 1)));
+
+  case HeightScaling:
+    return QSize(qRound(qreal(l_sprite_size.width()) * m_size.height() / qMax(l_sprite_size.height(), 1)), m_size.height());
   }
 }
 
+SpriteFrame SpritePlayer::transform_frame(SpriteFrame p_frame) const
+{
+  if (p_frame.image.isNull())
+  {
+    return p_frame;
+  }
+
+  const QSize l_sprite_size = m_reader->get_sprite_size();
+  if (m_resolved_scaling_mode != NoScaling && l_sprite_size.isValid() && m_scaled_canvas_size != l_sprite_size)
+  {
+    const qreal l_horizontal_factor = qreal(m_scaled_canvas_size.width()) / qMax(l_sprite_size.width(), 1);
+    const qreal l_vertical_factor = qreal(m_scaled_canvas_size.height()) / qMax(l_sprite_size.height(), 1);
+
+    // scale the edges rather than the size so that crops land on the same pixels as the full canvas
+    const QRect l_rect(p_frame.offset, p_frame.image.size());
+    const int l_left = qRound(l_rect.x() * l_horizontal_factor);
+    const int l_top = qRound(l_rect.y() * l_vertical_factor);
+    const int l_right = qRound((l_rect.x() + l_rect.width()) * l_horizontal_factor);
+    const int l_bottom = qRound((l_rect.y() + l_rect.height()) * l_vertical_factor);
+    p_frame.image = p_frame.image.scaled(QSize(qMax(1, l_right - l_left), qMax(1, l_bottom - l_top)), Qt::IgnoreAspectRatio, m_transform);
+    p_frame.offset = QPoint(l_left, l_top);
+  }
+
+  // slow operation...
+  if (m_mirror)
+  {
+    p_frame.image = p_frame.image.mirrored(true, false);
+    p_frame.offset.setX(m_scaled_canvas_size.width() - p_frame.offset.x() - p_frame.image.width());
+  }
+
+  return p_frame;
+}
+
+void SpritePlayer::clear_transformed_frames()
+{
+  release_transformed_frames();
+  m_current_frame_number = -1;
+}
+
+void SpritePlayer::release_transformed_frames()
+{
+  m_transformed_frame_list.clear();
+  if (m_transformed_memory > 0)
+  {
+    MemoryManager::get().AddUsage(transform_memory_consumer(), -m_transformed_memory);
+  }
+  m_transformed_memory = 0;
+}
+
 void SpritePlayer::scale_current_frame()
 {
-  QImage l_image = m_current_frame.image;
+  TransformKey l_key;
+  l_key.size = m_size;
+  l_key.scaling_mode = m_resolved_scaling_mode;
+  l_key.transform = m_transform;
+  l_key.mirror = m_mirror;
+  if (!(m_transform_key == l_key))
+  {
+    m_transform_key = l_key;
+    release_transformed_frames();
+  }
+  m_scaled_canvas_size = resolve_scaled_canvas_size();
 
-  if (!l_image.isNull())
+  // frames from a caching reader are transformed once, then reused on every following loop
+  // expanded frames are new images every time, so they are told apart by their source instead
+  const qint64 l_source_key = m_current_frame.source_key != 0 ? m_current_frame.source_key : m_current_frame.image.cacheKey();
+  const bool l_is_cacheable = !m_current_frame.image.isNull() && m_current_frame_number >= 0 && m_current_frame_number < m_frame_count && m_reader->is_caching();
+  if (l_is_cacheable)
   {
-    switch (m_resolved_scaling_mode)
+    if (m_transformed_frame_list.length() < m_frame_count)
+    {
+      m_transformed_frame_list.resize(m_frame_count);
+    }
+
+    // repeated frames share their pixels, so they can share the transformed frame as well
+    TransformedFrame &l_frame = m_transformed_frame_list[m_current_frame_number];
+    if (l_frame.source_key != l_source_key || l_frame.image.isNull())
+    {
+      for (const TransformedFrame &i_frame : qAsConst(m_transformed_frame_list))
+      {
+        if (i_frame.source_key == l_source_key && !i_frame.image.isNull())
+        {
+          l_frame = i_frame;
+          break;
+        }
+      }
+    }
+
+    if (l_frame.source_key == l_source_key && !l_frame.image.isNull())
     {
-    case NoScaling:
-      [[fallthrough]];
-    default:
-      break;
-
-    case StretchScaling:
-      l_image = l_image.scaled(m_size, Qt::IgnoreAspectRatio, m_transform);
-      break;
-
-    case WidthScaling:
-      l_image = l_image.scaledToWidth(m_size.width(), m_transform);
-      break;
-
-    case HeightScaling:
-      l_image = l_image.scaledToHeight(m_size.height(), m_transform);
-      break;
+      // a held frame looks exactly like the previous one
+      if (l_frame.image.cacheKey() == m_scaled_current_frame.cacheKey() && l_frame.offset == m_scaled_current_offset)
+      {
+        return;
+      }
+      m_scaled_current_frame = l_frame.image;
+      m_scaled_current_offset = l_frame.offset;
+      emit current_frame_changed();
+      return;
     }
   }
 
-  // slow operation...
-  if (m_mirror)
+  const SpriteFrame l_frame = transform_frame(m_current_frame);
+  const qint64 l_frame_memory = l_frame.image.sizeInBytes();
+  // under memory pressure frames are transformed again on every loop instead
+  if (l_is_cacheable && MemoryManager::get().EnsureHeadroom(l_frame_memory, MemoryManager::Priority::Cached))
   {
-    l_image = l_image.mirrored(true, false);
+    m_transformed_frame_list[m_current_frame_number] = TransformedFrame{l_source_key, l_frame.image, l_frame.offset};
+    m_transformed_memory += l_frame_memory;
+    MemoryManager::get().AddUsage(transform_memory_consumer(), l_frame_memory);
   }
 
-  m_scaled_current_frame = l_image;
+  m_scaled_current_frame = l_frame.image;
+  m_scaled_current_offset = l_frame.offset;
   emit current_frame_changed();
 }
@@ -25,6 +25,7 @@
 #include <QObject>
 #include <QSharedPointer>
 #include <QTimer>
+#include <QVector>
 
 #include <QElapsedTimer>
 
@@ -48,7 +49,9 @@ public:
   SpritePlayer(QObject *parent = nullptr);
   ~SpritePlayer();
 
+  // frames may be cropped; the offset places them within the scaled bounding rect
   QImage get_current_frame() const;
+  QPoint get_current_frame_offset() const;
   QImage get_current_native_frame() const;
 
   QRectF get_scaled_bounding_rect() const;
@@ -69,6 +72,14 @@ public:
 
   int get_frame();
 
+  // frames skipped to catch up with the clock, and frames shown more than a tick after their time
+  int get_dropped_frame_count() const;
+  int get_late_frame_count() const;
+
+  // summed over every player
+  static qint64 get_total_dropped_frame_count();
+  static qint64 get_total_late_frame_count();
+
 public slots:
   void set_play_once(bool enabled);
 
@@ -90,6 +101,8 @@ public slots:
 
   void start(int p_start_frame);
   void restart(int p_start_frame);
+
+  void reset_frame_statistics();
 signals:
   void current_frame_changed();
 
@@ -103,9 +116,33 @@ signals:
   void finished();
 
 private:
+  struct TransformKey
+  {
+    QSize size;
+    SpritePlayer::ScalingMode scaling_mode = NoScaling;
+    Qt::TransformationMode transform = Qt::FastTransformation;
+    bool mirror = false;
+
+    bool operator==(const TransformKey &other) const;
+  };
+
+  struct TransformedFrame
+  {
+    qint64 source_key = 0;
+    QImage image;
+    QPoint offset;
+  };
+
   SpriteReader::ptr m_reader;
   SpriteFrame m_current_frame;
+  int m_current_frame_number;
   QImage m_scaled_current_frame;
+  QPoint m_scaled_current_offset;
+  QSize m_scaled_canvas_size;
+  // scaled and mirrored frames of a caching reader, valid for m_transform_key only
+  TransformKey m_transform_key;
+  QVector<TransformedFrame> m_transformed_frame_list;
+  qint64 m_transformed_memory;
   SpritePlayer::ScalingMode m_scaling_mode;
   SpritePlayer::ScalingMode m_resolved_scaling_mode;
   Qt::TransformationMode m_transform;
@@ -116,10 +153,19 @@ private:
   int m_frame_count;
   int m_frame_number;
   QElapsedTimer m_elapsed_timer;
-  QTimer m_frame_timer;
+  // on the SpriteTicker clock
+  qint64 m_next_frame_time;
+  int m_dropped_frame_count;
+  int m_late_frame_count;
   QTimer m_repaint_timer;
 
   void resolve_scaling_mode();
+  QSize resolve_scaled_canvas_size() const;
+  SpriteFrame transform_frame(SpriteFrame frame) const;
+  void clear_transformed_frames();
+  void release_transformed_frames();
+
+  friend class SpriteTicker;
 
 private slots:
   void fetch_next_frame();
@@ -52,6 +52,7 @@ SpriteReader::SpriteReader(QObject *parent)
     , m_state{State::NotLoaded}
     , m_last_error{Error::NoError}
     , m_loading_progress{0}
+    , m_decode_priority{SpriteDecodeScheduler::Priority::VisibleNow}
 {
   registerMetatypes();
 }
@@ -77,6 +78,16 @@ bool SpriteReader::is_valid() const
   return get_frame_count() > 0;
 }
 
+bool SpriteReader::is_caching() const
+{
+  return false;
+}
+
+qint64 SpriteReader::get_mapped_bytes() const
+{
+  return 0;
+}
+
 QSize SpriteReader::get_sprite_size() const
 {
   return QSize{};
@@ -98,6 +109,11 @@ QVector<SpriteFrame> SpriteReader::get_frame_list()
   return QVector<SpriteFrame>{};
 }
 
+bool SpriteReader::can_play_through(int) const
+{
+  return is_loaded();
+}
+
 SpriteReader::State SpriteReader::get_state() const
 {
   return m_state;
@@ -118,6 +134,16 @@ SpriteReader::Error SpriteReader::get_last_error() const
   return m_last_error;
 }
 
+SpriteDecodeScheduler::Priority SpriteReader::get_decode_priority() const
+{
+  return m_decode_priority;
+}
+
+void SpriteReader::set_decode_priority(SpriteDecodeScheduler::Priority p_priority)
+{
+  m_decode_priority = p_priority;
+}
+
 void SpriteReader::set_file_name(QString p_file_name)
 {
   set_device(new QFile(p_file_name));
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include "mk2/spritedecodescheduler.h"
+
 #include <QObject>
 #include <QPixmap>
 #include <QSharedPointer>
@@ -29,8 +31,16 @@ namespace mk2
 class SpriteFrame
 {
 public:
+  // the raster engine composites premultiplied images without converting them first
+  static constexpr QImage::Format image_format = QImage::Format_ARGB32_Premultiplied;
+
   QImage image;
+  // position of the image on the sprite canvas; cached frames may be cropped to their opaque area
+  QPoint offset;
   int delay = 0;
+  // identifies the pixels when the image is rebuilt on every request, as with compressed frames; repeated
+  // frames share it
+  qint64 source_key = 0;
 
   SpriteFrame();
   ~SpriteFrame();
@@ -69,6 +79,12 @@ public:
 
   virtual bool is_valid() const;
 
+  // whether frames handed out stay in memory, so that anything derived from them can be kept too
+  virtual bool is_caching() const;
+
+  // bytes of the source file currently mapped by this reader
+  virtual qint64 get_mapped_bytes() const;
+
   virtual QSize get_sprite_size() const;
 
   virtual int get_frame_count() const;
@@ -77,6 +93,10 @@ public:
 
   virtual QVector<SpriteFrame> get_frame_list();
 
+  // whether playback starting now would never wait on the decoder; at least the given number of frames must be
+  // ready
+  virtual bool can_play_through(int preroll_frames) const;
+
   mk2::SpriteReader::State get_state() const;
 
   bool is_loaded() const;
@@ -85,6 +105,11 @@ public:
 
   Error get_last_error() const;
 
+  SpriteDecodeScheduler::Priority get_decode_priority() const;
+
+  // should be set before the file so that the first decode is already scheduled accordingly
+  virtual void set_decode_priority(SpriteDecodeScheduler::Priority priority);
+
 public slots:
   void set_file_name(QString file_name);
 
@@ -115,6 +140,7 @@ private:
   std::atomic<State> m_state;
   std::atomic<Error> m_last_error;
   std::atomic_int m_loading_progress;
+  SpriteDecodeScheduler::Priority m_decode_priority;
 
   void _p_delete_device();
 };
@@ -27,6 +27,8 @@ SpriteReaderSynchronizer::SpriteReaderSynchronizer(QObject *parent)
     , m_waiting{false}
     , m_finished{false}
     , m_threshold{50}
+    , m_play_through{false}
+    , m_preroll_frames{3}
 {}
 
 SpriteReaderSynchronizer::~SpriteReaderSynchronizer()
@@ -37,6 +39,16 @@ int SpriteReaderSynchronizer::get_threshold() const
   return m_threshold;
 }
 
+bool SpriteReaderSynchronizer::is_play_through() const
+{
+  return m_play_through;
+}
+
+int SpriteReaderSynchronizer::get_preroll_frames() const
+{
+  return m_preroll_frames;
+}
+
 QVector<SpriteReader::ptr> SpriteReaderSynchronizer::get_reader_list() const
 {
   return m_reader_list;
@@ -67,6 +79,31 @@ void SpriteReaderSynchronizer::set_threshold(int p_threshold)
   }
 }
 
+void SpriteReaderSynchronizer::set_play_through(bool p_enabled)
+{
+  if (m_play_through == p_enabled)
+  {
+    return;
+  }
+  m_play_through = p_enabled;
+  _p_check_progress();
+}
+
+void SpriteReaderSynchronizer::set_preroll_frames(int p_count)
+{
+  p_count = qMax(1, p_count);
+  if (m_preroll_frames == p_count)
+  {
+    return;
+  }
+  const int l_prev_count = m_preroll_frames;
+  m_preroll_frames = p_count;
+  if (m_preroll_frames < l_prev_count)
+  {
+    _p_check_progress();
+  }
+}
+
 void SpriteReaderSynchronizer::add(mk2::SpriteReader::ptr p_reader)
 {
   if (m_reader_list.contains(p_reader))
@@ -113,7 +150,7 @@ void SpriteReaderSynchronizer::_p_check_progress()
   for (const mk2::SpriteReader::ptr &i_reader : qAsConst(m_reader_list))
   {
     // if the reader is invalid, it's the same as being fully loaded
-    if (i_reader->is_valid() && i_reader->get_loading_progress() < m_threshold)
+    if (i_reader->is_valid() && !_p_is_ready(i_reader))
     {
       return;
     }
@@ -125,3 +162,12 @@ void SpriteReaderSynchronizer::_p_check_progress()
     emit finished();
   }
 }
+
+bool SpriteReaderSynchronizer::_p_is_ready(const mk2::SpriteReader::ptr &p_reader) const
+{
+  if (m_play_through)
+  {
+    return p_reader->can_play_through(m_preroll_frames);
+  }
+  return p_reader->get_loading_progress() >= m_threshold;
+}
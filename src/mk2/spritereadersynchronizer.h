@@ -26,6 +26,14 @@
 
 namespace mk2
 {
+/*!
+ * Waits for a set of readers before a message is shown.
+ *
+ * By default every reader has to reach the loading threshold. In play-through
+ * mode a reader is ready as soon as its first frames are decoded and its
+ * decoder keeps ahead of playback, so long animations no longer hold the
+ * message until a fixed share of their frames is decoded.
+ */
 class SpriteReaderSynchronizer : public QObject
 {
   Q_OBJECT
@@ -36,6 +44,10 @@ public:
 
   int get_threshold() const;
 
+  bool is_play_through() const;
+
+  int get_preroll_frames() const;
+
   QVector<mk2::SpriteReader::ptr> get_reader_list() const;
 
   bool is_waiting() const;
@@ -45,6 +57,10 @@ public:
 public slots:
   void set_threshold(int percent);
 
+  void set_play_through(bool enabled);
+
+  void set_preroll_frames(int count);
+
   void add(mk2::SpriteReader::ptr reader);
 
   void clear();
@@ -59,6 +75,10 @@ private:
   bool m_waiting;
   bool m_finished;
   int m_threshold;
+  bool m_play_through;
+  int m_preroll_frames;
+
+  bool _p_is_ready(const mk2::SpriteReader::ptr &reader) const;
 
 private slots:
   void _p_check_progress();
@@ -20,17 +20,53 @@
 
 #include "mk2/spriteseekingreader.h"
 
+#include "mk2/spritecache.h"
+#include "modules/debug/profiler.h"
+#include "modules/managers/memory_manager.h"
+
+#include <QPainter>
+
 using namespace mk2;
 
+namespace
+{
+std::atomic<qint64> s_index_memory_cap = 16ll * 1024 * 1024;
+
+int checkpoint_memory_consumer()
+{
+  static const int s_consumer = MemoryManager::get().RegisterConsumer("sprite checkpoints", MemoryManager::Priority::Cached);
+  return s_consumer;
+}
+} // namespace
+
+qint64 SpriteSeekingReader::get_index_memory_cap()
+{
+  return s_index_memory_cap;
+}
+
+void SpriteSeekingReader::set_index_memory_cap(qint64 p_bytes)
+{
+  s_index_memory_cap = qMax(0ll, p_bytes);
+}
+
 SpriteSeekingReader::SpriteSeekingReader(QObject *parent)
     : SpriteReader{parent}
     , m_sprite_size(QSize{})
     , m_frame_count{0}
     , m_frame_number{-1}
+    , m_checkpoint_interval{0}
+    , m_checkpoint_memory{0}
 {}
 
 SpriteSeekingReader::~SpriteSeekingReader()
-{}
+{
+  _p_reset_checkpoints();
+}
+
+qint64 SpriteSeekingReader::get_mapped_bytes() const
+{
+  return m_source && m_source->is_mapped() ? m_source->get_size() : 0;
+}
 
 QSize SpriteSeekingReader::get_sprite_size() const
 {
@@ -49,27 +85,56 @@ mk2::SpriteFrame SpriteSeekingReader::get_frame(int p_number)
     return SpriteFrame{};
   }
 
+  if (m_entry)
+  {
+    return m_entry->get_frame(p_number);
+  }
+
   if (p_number == m_frame_number)
   {
     return m_current_frame;
   }
 
-  { // check whatever we need to rewind the device or not
-    const int l_next_frame_number = m_frame_number + 1;
-    if (p_number < l_next_frame_number)
-    {
-      _p_reset_buffer_device();
-    }
+  // frames seen in a previous pass do not need the decoder at all
+  if (m_checkpoint_map.contains(p_number))
+  {
+    return m_checkpoint_map.value(p_number);
   }
 
+  // packed frames can be expanded in any order
+  if (m_disk_record)
+  {
+    m_current_frame = m_disk_record->get_frame(p_number);
+    m_frame_number = p_number;
+    return m_current_frame;
+  }
+
+  _p_seek_decoder(p_number);
+
   // seek frame
+  DR_PROFILE_SCOPE("SpriteSeekingReader decode");
   QImage l_image(m_reader.size(), QImage::Format_ARGB32);
-  for (; m_frame_number < p_number; ++m_frame_number)
+  while (m_frame_number < p_number)
   {
     m_reader.read(&l_image);
     m_current_frame.delay = m_reader.nextImageDelay();
+    m_current_frame.image = l_image.convertToFormat(SpriteFrame::image_format);
+    ++m_frame_number;
+    if (_p_is_keyframe(m_frame_number))
+    {
+      m_resume_base = QImage{};
+    }
+    else if (!m_resume_base.isNull())
+    {
+      // gif pixels are either opaque or transparent, so whatever the decoder left transparent shows the base
+      QImage l_composited_image = m_resume_base;
+      QPainter l_painter(&l_composited_image);
+      l_painter.drawImage(0, 0, m_current_frame.image);
+      l_painter.end();
+      m_current_frame.image = l_composited_image;
+    }
+    _p_add_checkpoint(m_frame_number, m_current_frame);
   }
-  m_current_frame.image = l_image;
 
   return m_current_frame;
 }
@@ -78,6 +143,11 @@ QVector<mk2::SpriteFrame> SpriteSeekingReader::get_frame_list()
 {
   QVector<SpriteFrame> l_frame_list;
 
+  if (m_entry)
+  {
+    return m_entry->get_frame_list();
+  }
+
   if (is_valid())
   {
     l_frame_list.resize(m_reader.imageCount());
@@ -97,20 +167,35 @@ QVector<mk2::SpriteFrame> SpriteSeekingReader::get_frame_list()
 
 void SpriteSeekingReader::load()
 {
-  m_raw_data.clear();
+  m_entry.reset();
+  m_disk_record.reset();
+  m_reader.setDevice(nullptr);
+  m_data_buffer.reset();
+  m_source.reset();
   m_sprite_size = QSize{};
   m_frame_count = 0;
+  m_stream_header.clear();
+  m_frame_layout_list.clear();
+  _p_reset_checkpoints();
 
-  QIODevice *l_device = get_device();
-  const int l_prev_pos = l_device->pos();
-  if (!l_device->isOpen() && !l_device->open(QIODevice::ReadOnly))
+  // frames decoded by another reader are served without touching the device
+  if (SpriteCacheEntry::ptr l_entry = SpriteCache::find(get_file_name()))
+  {
+    m_entry = l_entry;
+    m_sprite_size = m_entry->get_sprite_size();
+    m_frame_count = m_entry->get_frame_count();
+    m_current_frame = SpriteFrame{};
+    set_loading_progress(100);
+    set_state(State::FullyLoaded);
+    return;
+  }
+
+  m_source = SpriteMappedFile::open(get_device());
+  if (!m_source)
   {
     set_error(Error::DeviceError);
     return;
   }
-  l_device->seek(0);
-  m_raw_data = l_device->readAll();
-  l_device->seek(l_prev_pos);
   _p_reset_buffer_device();
   if (!m_reader.canRead())
   {
@@ -120,21 +205,246 @@ void SpriteSeekingReader::load()
   m_sprite_size = m_reader.size();
   m_frame_count = m_reader.imageCount();
   m_current_frame = SpriteFrame{};
+  _p_read_frame_layout();
+
+  // this runs on the GUI thread, so the source is hashed in the background for the next load instead
+  const QString l_cache_key = SpriteCache::get_cache_key(get_file_name());
+  if (SpriteDiskRecord::ptr l_record = SpriteDiskCache::find(l_cache_key, m_source, false))
+  {
+    if (l_record->sprite_size == m_sprite_size && l_record->get_frame_count() == m_frame_count)
+    {
+      m_disk_record = l_record;
+      set_loading_progress(100);
+      set_state(State::FullyLoaded);
+      return;
+    }
+  }
+  else
+  {
+    SpriteDiskCache::prepare(l_cache_key, m_source);
+  }
+
+  // spread as many checkpoints as the memory cap allows evenly over the animation; when every frame fits, loops
+  // never touch the decoder again
+  if (m_frame_count > 1 && m_sprite_size.isValid())
+  {
+    const qint64 l_frame_memory = qMax(1ll, qint64(m_sprite_size.width()) * m_sprite_size.height() * 4);
+    const qint64 l_max_checkpoints = s_index_memory_cap / l_frame_memory;
+    if (l_max_checkpoints > 0)
+    {
+      m_checkpoint_interval = qMax(1, int((m_frame_count + l_max_checkpoints - 1) / l_max_checkpoints));
+    }
+  }
   set_loading_progress(100);
   set_state(State::FullyLoaded);
 }
 
-void SpriteSeekingReader::_p_reset_buffer_device()
+void SpriteSeekingReader::_p_reset_buffer_device(int p_frame_number)
 {
-  m_data_buffer.reset(new QBuffer(&m_raw_data));
+  // the reader keeps a pointer to the previous device until it is given the new one
+  QScopedPointer<SpriteMappedDevice> l_prev_buffer(m_data_buffer.take());
+  if (p_frame_number > 0)
+  {
+    m_data_buffer.reset(new SpriteMappedDevice(m_source, m_stream_header, m_frame_layout_list.at(p_frame_number).offset));
+  }
+  else
+  {
+    m_data_buffer.reset(new SpriteMappedDevice(m_source));
+  }
 
   if (m_data_buffer->open(QIODevice::ReadOnly))
   {
     m_reader.setDevice(m_data_buffer.data());
-    m_frame_number = -1;
+    m_frame_number = qMax(0, p_frame_number) - 1;
+    m_resume_base = QImage{};
   }
   else
   {
     set_error(Error::DeviceError);
   }
 }
+
+void SpriteSeekingReader::_p_reset_checkpoints()
+{
+  m_checkpoint_map.clear();
+  m_checkpoint_interval = 0;
+  if (m_checkpoint_memory > 0)
+  {
+    MemoryManager::get().AddUsage(checkpoint_memory_consumer(), -m_checkpoint_memory);
+  }
+  m_checkpoint_memory = 0;
+}
+
+void SpriteSeekingReader::_p_add_checkpoint(int p_frame_number, const SpriteFrame &p_frame)
+{
+  if (m_checkpoint_interval <= 0 || p_frame_number % m_checkpoint_interval != 0 || m_checkpoint_map.contains(p_frame_number))
+  {
+    return;
+  }
+
+  const qint64 l_frame_memory = p_frame.image.sizeInBytes();
+  if (m_checkpoint_memory + l_frame_memory > s_index_memory_cap || !MemoryManager::get().EnsureHeadroom(l_frame_memory, MemoryManager::Priority::Cached))
+  {
+    return;
+  }
+  m_checkpoint_memory += l_frame_memory;
+  MemoryManager::get().AddUsage(checkpoint_memory_consumer(), l_frame_memory);
+  m_checkpoint_map.insert(p_frame_number, p_frame);
+}
+
+void SpriteSeekingReader::_p_read_frame_layout()
+{
+  m_stream_header.clear();
+  m_frame_layout_list.clear();
+  if (m_reader.format() != "gif")
+  {
+    return;
+  }
+
+  const uchar *l_data = m_source->get_data();
+  const qint64 l_size = m_source->get_size();
+  if (l_size < 13)
+  {
+    return;
+  }
+
+  // returns the position after the terminator of a chain of data sub-blocks, or -1 when the file ends first
+  const auto l_skip_sub_blocks = [l_data, l_size](qint64 p_pos) -> qint64 {
+    while (p_pos < l_size)
+    {
+      const int l_block_size = l_data[p_pos];
+      p_pos += 1 + l_block_size;
+      if (l_block_size == 0)
+      {
+        return p_pos;
+      }
+    }
+    return -1;
+  };
+  const auto l_read_uint16 = [l_data](qint64 p_pos) {
+    return int(l_data[p_pos]) | (int(l_data[p_pos + 1]) << 8);
+  };
+
+  // header, logical screen descriptor and global color table
+  qint64 l_pos = 13;
+  if (l_data[10] & 0x80)
+  {
+    l_pos += 3 * (1 << ((l_data[10] & 0x07) + 1));
+  }
+  const qint64 l_header_size = l_pos;
+
+  QVector<FrameLayout> l_frame_layout_list;
+  FrameLayout l_frame_layout;
+  l_frame_layout.offset = l_pos;
+  while (l_pos < l_size && l_data[l_pos] != 0x3B)
+  {
+    if (l_data[l_pos] == 0x21 && l_pos + 1 < l_size)
+    {
+      // graphic control extension
+      if (l_data[l_pos + 1] == 0xF9 && l_pos + 3 < l_size)
+      {
+        l_frame_layout.disposal = (l_data[l_pos + 3] >> 2) & 0x07;
+        l_frame_layout.transparent = l_data[l_pos + 3] & 0x01;
+      }
+      l_pos = l_skip_sub_blocks(l_pos + 2);
+    }
+    else if (l_data[l_pos] == 0x2C && l_pos + 10 <= l_size)
+    {
+      l_frame_layout.rect = QRect(l_read_uint16(l_pos + 1), l_read_uint16(l_pos + 3), l_read_uint16(l_pos + 5), l_read_uint16(l_pos + 7));
+      const uchar l_flags = l_data[l_pos + 9];
+      l_pos += 10;
+      if (l_flags & 0x80)
+      {
+        l_pos += 3 * (1 << ((l_flags & 0x07) + 1));
+      }
+      // skips the minimum code size as well
+      l_pos = l_skip_sub_blocks(l_pos + 1);
+      l_frame_layout_list.append(l_frame_layout);
+      l_frame_layout = FrameLayout{};
+      l_frame_layout.offset = l_pos;
+    }
+    else
+    {
+      return;
+    }
+
+    if (l_pos == -1)
+    {
+      return;
+    }
+  }
+
+  if (l_frame_layout_list.length() != m_frame_count)
+  {
+    return;
+  }
+  m_stream_header = QByteArray(reinterpret_cast<const char *>(l_data), int(l_header_size));
+  m_frame_layout_list = std::move(l_frame_layout_list);
+}
+
+// whether the frame comes out the same no matter what was drawn before it, so that a fresh decoder can start there
+bool SpriteSeekingReader::_p_is_keyframe(int p_frame_number) const
+{
+  if (p_frame_number == 0)
+  {
+    return true;
+  }
+
+  if (p_frame_number < 0 || p_frame_number >= m_frame_layout_list.length())
+  {
+    return false;
+  }
+
+  const QRect l_canvas_rect(QPoint(0, 0), m_sprite_size);
+  const FrameLayout &l_previous_layout = m_frame_layout_list.at(p_frame_number - 1);
+  const FrameLayout &l_layout = m_frame_layout_list.at(p_frame_number);
+
+  // the previous frame clears the whole canvas to transparent once it is done
+  if (l_previous_layout.disposal == 2 && l_previous_layout.transparent && l_layout.transparent && l_previous_layout.rect.contains(l_canvas_rect))
+  {
+    return true;
+  }
+
+  // the frame paints over the whole canvas, and never brings back what was underneath
+  return !l_layout.transparent && l_layout.disposal != 3 && l_layout.rect.contains(l_canvas_rect);
+}
+
+// keeps the current decoder when it is on the way to the frame, otherwise starts decoding over from the latest
+// keyframe or checkpoint before it
+void SpriteSeekingReader::_p_seek_decoder(int p_frame_number)
+{
+  const bool l_is_forward = p_frame_number > m_frame_number;
+  if (m_frame_layout_list.isEmpty())
+  {
+    if (!l_is_forward)
+    {
+      _p_reset_buffer_device();
+    }
+    return;
+  }
+
+  // whether each frame after i up to the target is drawn over the previous canvas without clearing any of it
+  bool l_is_overlay_chain = true;
+  for (int i = p_frame_number; i >= 0; --i)
+  {
+    const bool l_can_overlay = i > 0 && l_is_overlay_chain && m_frame_layout_list.at(i - 1).disposal <= 1;
+    if (l_is_forward && i == m_frame_number + 1 && (m_resume_base.isNull() || _p_is_keyframe(i) || l_can_overlay))
+    {
+      return;
+    }
+
+    if (_p_is_keyframe(i))
+    {
+      _p_reset_buffer_device(i);
+      return;
+    }
+
+    if (l_can_overlay && m_checkpoint_map.contains(i - 1))
+    {
+      _p_reset_buffer_device(i);
+      m_resume_base = m_checkpoint_map.value(i - 1).image;
+      return;
+    }
+    l_is_overlay_chain = l_can_overlay;
+  }
+}
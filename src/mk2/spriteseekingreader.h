@@ -20,12 +20,17 @@
 
 #pragma once
 
+#include "mk2/spritecacheentry.h"
+#include "mk2/spritediskcache.h"
 #include "mk2/spritereader.h"
 
-#include <QBuffer>
-#include <QByteArray>
+#include "mk2/spritemappedfile.h"
+
 #include <QImageReader>
+#include <QMap>
+#include <QRect>
 #include <QScopedPointer>
+#include <QVector>
 
 namespace mk2
 {
@@ -34,9 +39,14 @@ class SpriteSeekingReader : public SpriteReader
   Q_OBJECT
 
 public:
+  static qint64 get_index_memory_cap();
+  static void set_index_memory_cap(qint64 bytes);
+
   explicit SpriteSeekingReader(QObject *parent = nullptr);
   virtual ~SpriteSeekingReader();
 
+  qint64 get_mapped_bytes() const final;
+
   QSize get_sprite_size() const final;
 
   int get_frame_count() const final;
@@ -49,14 +59,43 @@ protected:
   void load() final;
 
 private:
-  QByteArray m_raw_data;
+  SpriteCacheEntry::ptr m_entry;
+  // frames are expanded straight from the disk cache when it holds them
+  SpriteDiskRecord::ptr m_disk_record;
+  SpriteMappedFile::ptr m_source;
   QImageReader m_reader;
-  QScopedPointer<QBuffer> m_data_buffer;
+  QScopedPointer<SpriteMappedDevice> m_data_buffer;
   QSize m_sprite_size;
   int m_frame_count;
   int m_frame_number;
   SpriteFrame m_current_frame;
 
-  void _p_reset_buffer_device();
+  // composited frames kept from previous passes, keyed by frame number
+  QMap<int, SpriteFrame> m_checkpoint_map;
+  int m_checkpoint_interval;
+  qint64 m_checkpoint_memory;
+
+  // gif streams only: where each frame starts in the file and how it is disposed of, so that decoding can be
+  // resumed mid-file behind a copy of the stream header
+  struct FrameLayout
+  {
+    qint64 offset = 0;
+    QRect rect;
+    int disposal = 0;
+    bool transparent = false;
+  };
+  QByteArray m_stream_header;
+  QVector<FrameLayout> m_frame_layout_list;
+  // a resumed decoder only holds what it drew itself; the rest of the canvas comes from this checkpoint until the
+  // decoder reaches a frame that does not depend on the previous ones
+  QImage m_resume_base;
+
+  // frames other than the first one need the frame layout
+  void _p_reset_buffer_device(int frame_number = 0);
+  void _p_reset_checkpoints();
+  void _p_add_checkpoint(int frame_number, const SpriteFrame &frame);
+  void _p_read_frame_layout();
+  bool _p_is_keyframe(int frame_number) const;
+  void _p_seek_decoder(int frame_number);
 };
 } // namespace mk2
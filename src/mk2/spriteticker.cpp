@@ -0,0 +1,200 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#include "mk2/spriteticker.h"
+
+#include "mk2/spriteplayer.h"
+#include "modules/debug/profiler.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QPointer>
+#include <QScreen>
+#include <QTimer>
+#include <QVector>
+
+using namespace mk2;
+
+namespace
+{
+// players are GUI objects, so the ticker is only ever touched from the main thread
+struct SpriteTickerData
+{
+  SpriteTickerData()
+  {
+    clock.start();
+  }
+
+  QElapsedTimer clock;
+  QTimer *timer = nullptr;
+  // resolved from the primary screen on first use
+  int interval = 0;
+  bool ticking = false;
+  bool frame_dropping = true;
+  QVector<SpritePlayer *> player_list;
+};
+
+SpriteTickerData &ticker_data()
+{
+  static SpriteTickerData s_data;
+  return s_data;
+}
+
+int resolve_interval()
+{
+  if (QScreen *l_screen = QGuiApplication::primaryScreen())
+  {
+    const qreal l_refresh_rate = l_screen->refreshRate();
+    if (l_refresh_rate > 0.0)
+    {
+      return qBound(4, qRound(1000.0 / l_refresh_rate), 50);
+    }
+  }
+  return 16;
+}
+} // namespace
+
+qint64 SpriteTicker::get_time()
+{
+  return ticker_data().clock.elapsed();
+}
+
+int SpriteTicker::get_interval()
+{
+  SpriteTickerData &l_data = ticker_data();
+  if (l_data.interval == 0)
+  {
+    l_data.interval = resolve_interval();
+  }
+  return l_data.interval;
+}
+
+void SpriteTicker::set_interval(int p_msecs)
+{
+  ticker_data().interval = qMax(1, p_msecs);
+  reschedule();
+}
+
+bool SpriteTicker::is_frame_dropping_enabled()
+{
+  return ticker_data().frame_dropping;
+}
+
+void SpriteTicker::set_frame_dropping_enabled(bool p_enabled)
+{
+  ticker_data().frame_dropping = p_enabled;
+}
+
+void SpriteTicker::subscribe(SpritePlayer *p_player)
+{
+  SpriteTickerData &l_data = ticker_data();
+  if (!l_data.player_list.contains(p_player))
+  {
+    l_data.player_list.append(p_player);
+  }
+  reschedule();
+}
+
+// the timer is left alone; a tick with nobody due simply stops it
+void SpriteTicker::unsubscribe(SpritePlayer *p_player)
+{
+  ticker_data().player_list.removeAll(p_player);
+}
+
+void SpriteTicker::reschedule()
+{
+  SpriteTickerData &l_data = ticker_data();
+  if (l_data.ticking)
+  {
+    return;
+  }
+
+  if (l_data.player_list.isEmpty())
+  {
+    if (l_data.timer)
+    {
+      l_data.timer->stop();
+    }
+    return;
+  }
+
+  if (l_data.timer == nullptr)
+  {
+    // owned by the application so that it is gone before static teardown
+    l_data.timer = new QTimer(QCoreApplication::instance());
+    l_data.timer->setTimerType(Qt::PreciseTimer);
+    l_data.timer->setSingleShot(true);
+    QObject::connect(l_data.timer, &QTimer::timeout, &SpriteTicker::_p_tick);
+  }
+
+  qint64 l_next_frame_time = l_data.player_list.first()->m_next_frame_time;
+  for (SpritePlayer *i_player : qAsConst(l_data.player_list))
+  {
+    l_next_frame_time = qMin(l_next_frame_time, i_player->m_next_frame_time);
+  }
+
+  // round up to the next grid point so that nearby deadlines share a tick
+  const qint64 l_time = get_time();
+  const qint64 l_interval = get_interval();
+  const qint64 l_tick_time = ((qMax(l_next_frame_time, l_time) + l_interval - 1) / l_interval) * l_interval;
+  const int l_delay = int(l_tick_time - l_time);
+  if (l_data.timer->isActive() && l_data.timer->remainingTime() <= l_delay)
+  {
+    return;
+  }
+  l_data.timer->start(l_delay);
+}
+
+void SpriteTicker::_p_tick()
+{
+  DR_PROFILE_FUNCTION();
+  SpriteTickerData &l_data = ticker_data();
+
+  // players may finish, stop or even delete one another while advancing
+  QVector<QPointer<SpritePlayer>> l_player_list;
+  l_player_list.reserve(l_data.player_list.length());
+  for (SpritePlayer *i_player : qAsConst(l_data.player_list))
+  {
+    l_player_list.append(i_player);
+  }
+
+  const qint64 l_time = get_time();
+  int l_advance_count = 0;
+  l_data.ticking = true;
+  for (const QPointer<SpritePlayer> &i_player : qAsConst(l_player_list))
+  {
+    if (i_player.isNull() || !l_data.player_list.contains(i_player.data()))
+    {
+      continue;
+    }
+
+    // timers may fire a little early; a millisecond of slack keeps that from costing a whole tick
+    if (i_player->m_next_frame_time <= l_time + 1)
+    {
+      i_player->fetch_next_frame();
+      ++l_advance_count;
+    }
+  }
+  l_data.ticking = false;
+  DR_PROFILE_COUNTER("sprite ticker players", l_advance_count);
+
+  reschedule();
+}
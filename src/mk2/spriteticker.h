@@ -0,0 +1,63 @@
+/**************************************************************************
+**
+** mk2
+** Copyright (C) 2022 Tricky Leifa
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Affero General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**
+**************************************************************************/
+
+#pragma once
+
+#include <QtGlobal>
+
+namespace mk2
+{
+class SpritePlayer;
+
+/*!
+ * Animation clock shared by every running SpritePlayer.
+ *
+ * Ticks fall on a fixed grid matching the refresh rate of the primary screen.
+ * The clock only wakes up on grid points where at least one player is due and
+ * advances every due player on the same tick, so their repaints land in the
+ * same scene update. It stops entirely while nothing is playing.
+ *
+ * With frame dropping enabled, players that fall behind the clock skip the
+ * frames whose display time has already passed instead of slowing down.
+ */
+class SpriteTicker
+{
+public:
+  // milliseconds on the shared monotonic clock
+  static qint64 get_time();
+
+  static int get_interval();
+  static void set_interval(int msecs);
+
+  static bool is_frame_dropping_enabled();
+  static void set_frame_dropping_enabled(bool enabled);
+
+  static void subscribe(SpritePlayer *player);
+  static void unsubscribe(SpritePlayer *player);
+
+  // to be called whenever the next frame time of a subscribed player changes
+  static void reschedule();
+
+private:
+  SpriteTicker() = delete;
+
+  static void _p_tick();
+};
+} // namespace mk2
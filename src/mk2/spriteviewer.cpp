@@ -22,6 +22,7 @@
 #include "mk2/spritedynamicreader.h"
 
 #include <QFile>
+#include <QPainter>
 #include <QResizeEvent>
 
 using namespace mk2;
@@ -149,5 +150,19 @@ void SpriteViewer::resizeEvent(QResizeEvent *p_event)
 
 void SpriteViewer::paint_frame()
 {
-  setPixmap(QPixmap::fromImage(m_player->get_current_frame()));
+  const QImage l_image = m_player->get_current_frame();
+  const QSize l_canvas_size = m_player->get_scaled_bounding_rect().size().toSize();
+  if (l_image.isNull() || (l_image.size() == l_canvas_size && m_player->get_current_frame_offset().isNull()))
+  {
+    setPixmap(QPixmap::fromImage(l_image));
+    return;
+  }
+
+  // cropped frames are placed back onto their canvas
+  QPixmap l_pixmap(l_canvas_size);
+  l_pixmap.fill(Qt::transparent);
+  QPainter l_painter(&l_pixmap);
+  l_painter.drawImage(m_player->get_current_frame_offset(), l_image);
+  l_painter.end();
+  setPixmap(l_pixmap);
 }
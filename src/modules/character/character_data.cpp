@@ -6,6 +6,11 @@ CharacterData::CharacterData()
 
 }
 
+CharacterData::~CharacterData()
+{
+
+}
+
 QString CharacterData::getEmoteButton(DREmote t_emote, bool t_enabled)
 {
   QString l_texture = AOApplication::getInstance()->get_character_path(t_emote.character, QString("emotions/button%1_off.png").arg(t_emote.key));
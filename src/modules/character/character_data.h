@@ -2,11 +2,15 @@
 #define CHARACTERDATA_H
 #include <datatypes.h>
 #include <qstring.h>
+#include <QSharedPointer>
 
 class CharacterData
 {
 public:
+  using ptr = QSharedPointer<CharacterData>;
+
   CharacterData();
+  virtual ~CharacterData();
 
   virtual QString getEmoteButton(DREmote t_emote, bool t_enabled);
   virtual QString getSelectedImage(DREmote t_emote);
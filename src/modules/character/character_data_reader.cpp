@@ -32,24 +32,14 @@ QString CharacterDataReader::getEmoteButton(DREmote t_emote, bool t_enabled)
 void CharacterDataReader::loadOutfits()
 {
   mOutfitNames.clear();
+  mOutfits.clear();
   QDir l_outfitsDirectory(AOApplication::getInstance()->get_character_folder_path(mFolder) + "/outfits");
 
   QStringList l_outfitSubDirectories = l_outfitsDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
 
   if(l_outfitSubDirectories.length() <= 0) return;
   if(!l_outfitSubDirectories.contains("default")) mOutfit = l_outfitSubDirectories[0];
-  for (const QString &f_outfitPath : l_outfitSubDirectories)
-  {
-
-    QDir l_outfitPathFull(l_outfitsDirectory.filePath(f_outfitPath));
-
-    if(!mOutfits.contains(f_outfitPath))
-    {
-      mOutfitNames.append(f_outfitPath);
-      mOutfits[f_outfitPath] = new OutfitReader(mFolder, f_outfitPath);
-    }
-
-  }
+  mOutfitNames = l_outfitSubDirectories;
 }
 
 QVector<DREmote> CharacterDataReader::getEmotes()
@@ -61,11 +51,14 @@ QVector<DREmote> CharacterDataReader::getEmotes()
     return l_allEmotes;
   }
 
-  if(mOutfits.contains(mOutfit))
+  if(!mOutfitNames.contains(mOutfit)) return {};
+
+  QSharedPointer<OutfitReader> &l_outfit = mOutfits[mOutfit];
+  if(l_outfit.isNull())
   {
-    return mOutfits[mOutfit]->mEmotes;
+    l_outfit.reset(new OutfitReader(mFolder, mOutfit));
   }
-  return {};
+  return l_outfit->mEmotes;
 }
 
 QString CharacterDataReader::getSelectedImage(DREmote t_emote)
@@ -19,7 +19,8 @@ public:
 
 private:
   void loadOutfits();
-  QMap<QString, OutfitReader*> mOutfits = {};
+  // outfits are only read once their emotes are requested
+  QMap<QString, QSharedPointer<OutfitReader>> mOutfits = {};
   QStringList mOutfitNames = {};
 
   QVector<DREmote> getEmotes();
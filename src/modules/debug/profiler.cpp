@@ -0,0 +1,205 @@
+#include "profiler.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+
+Profiler Profiler::s_Instance;
+
+namespace
+{
+// per thread; a full buffer costs roughly 640 KiB
+constexpr int s_ThreadBufferCapacity = 16384;
+} // namespace
+
+Profiler::Profiler()
+{
+  m_Clock.start();
+}
+
+void Profiler::SetEnabled(bool t_enabled)
+{
+  m_Enabled.store(t_enabled, std::memory_order_relaxed);
+}
+
+qint64 Profiler::GetTimestamp() const
+{
+  return m_Clock.nsecsElapsed();
+}
+
+const char *Profiler::InternName(QString t_name)
+{
+  const QByteArray l_name = t_name.toUtf8();
+  QMutexLocker l_locker(&m_Lock);
+  auto l_it = m_InternedNames.constFind(l_name);
+  if (l_it == m_InternedNames.constEnd())
+  {
+    l_it = m_InternedNames.insert(l_name);
+  }
+  // elements of a QSet are never moved in memory and the set only grows
+  return l_it->constData();
+}
+
+int Profiler::EnterZone()
+{
+  return GetThreadBuffer().mDepth++;
+}
+
+void Profiler::LeaveZone()
+{
+  ThreadBuffer &l_buffer = GetThreadBuffer();
+  l_buffer.mDepth = qMax(0, l_buffer.mDepth - 1);
+}
+
+void Profiler::RecordZone(const char *t_name, qint64 t_start, qint64 t_end, int t_depth)
+{
+  Event l_event;
+  l_event.mName = t_name;
+  l_event.mType = EventType::Zone;
+  l_event.mStart = t_start;
+  l_event.mDuration = t_end - t_start;
+  l_event.mDepth = t_depth;
+  Record(l_event);
+}
+
+void Profiler::RecordCounter(const char *t_name, qint64 t_value)
+{
+  Event l_event;
+  l_event.mName = t_name;
+  l_event.mType = EventType::Counter;
+  l_event.mStart = GetTimestamp();
+  l_event.mValue = t_value;
+  Record(l_event);
+}
+
+void Profiler::RecordMark(const char *t_name)
+{
+  Event l_event;
+  l_event.mName = t_name;
+  l_event.mType = EventType::Mark;
+  l_event.mStart = GetTimestamp();
+  Record(l_event);
+}
+
+bool Profiler::ExportChromeTrace(QString t_filePath)
+{
+  QVector<std::shared_ptr<ThreadBuffer>> l_bufferList;
+  {
+    QMutexLocker l_locker(&m_Lock);
+    l_bufferList = m_Buffers;
+  }
+
+  const qint64 l_processId = QCoreApplication::applicationPid();
+  QJsonArray l_eventList;
+  for (const std::shared_ptr<ThreadBuffer> &i_buffer : qAsConst(l_bufferList))
+  {
+    QJsonObject l_threadName;
+    l_threadName["ph"] = "M";
+    l_threadName["name"] = "thread_name";
+    l_threadName["pid"] = l_processId;
+    l_threadName["tid"] = qint64(i_buffer->mThreadId);
+    l_threadName["args"] = QJsonObject{{"name", i_buffer->mThreadName}};
+    l_eventList.append(l_threadName);
+
+    // copy first, then drop whatever the owning thread may have overwritten meanwhile
+    const quint64 l_capacity = quint64(i_buffer->mEvents.size());
+    const quint64 l_writeCount = i_buffer->mWriteCount.load(std::memory_order_acquire);
+    const quint64 l_firstIndex = l_writeCount > l_capacity ? l_writeCount - l_capacity : 0;
+    QVector<Event> l_events;
+    l_events.reserve(int(l_writeCount - l_firstIndex));
+    for (quint64 i = l_firstIndex; i < l_writeCount; ++i)
+    {
+      l_events.append(i_buffer->mEvents[i % l_capacity]);
+    }
+    const quint64 l_laterWriteCount = i_buffer->mWriteCount.load(std::memory_order_acquire);
+    const quint64 l_overwrittenCount = l_laterWriteCount > l_capacity ? qMin(l_laterWriteCount - l_capacity, l_writeCount) : 0;
+    const int l_skipCount = int(l_overwrittenCount > l_firstIndex ? l_overwrittenCount - l_firstIndex : 0);
+
+    for (int i = l_skipCount; i < l_events.length(); ++i)
+    {
+      const Event &l_event = l_events.at(i);
+      QJsonObject l_object;
+      l_object["name"] = QString::fromUtf8(l_event.mName);
+      l_object["pid"] = l_processId;
+      l_object["tid"] = qint64(i_buffer->mThreadId);
+      l_object["ts"] = double(l_event.mStart) / 1000.0;
+      switch (l_event.mType)
+      {
+      case EventType::Zone:
+        l_object["ph"] = "X";
+        l_object["dur"] = double(l_event.mDuration) / 1000.0;
+        l_object["args"] = QJsonObject{{"depth", l_event.mDepth}};
+        break;
+      case EventType::Counter:
+        l_object["ph"] = "C";
+        l_object["args"] = QJsonObject{{"value", l_event.mValue}};
+        break;
+      case EventType::Mark:
+        l_object["ph"] = "i";
+        l_object["s"] = "t";
+        break;
+      }
+      l_eventList.append(l_object);
+    }
+  }
+
+  QFile l_file(t_filePath);
+  if (!l_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << "[profiler] failed to write trace:" << t_filePath << l_file.errorString();
+    return false;
+  }
+  QJsonObject l_trace;
+  l_trace["traceEvents"] = l_eventList;
+  l_trace["displayTimeUnit"] = "ms";
+  l_file.write(QJsonDocument(l_trace).toJson(QJsonDocument::Compact));
+  qInfo() << "[profiler] trace written to" << t_filePath;
+  return true;
+}
+
+// events recorded while clearing may survive it
+void Profiler::Clear()
+{
+  QMutexLocker l_locker(&m_Lock);
+  for (const std::shared_ptr<ThreadBuffer> &i_buffer : qAsConst(m_Buffers))
+  {
+    i_buffer->mWriteCount.store(0, std::memory_order_release);
+  }
+}
+
+Profiler::ThreadBuffer &Profiler::GetThreadBuffer()
+{
+  // the registry keeps the buffer alive after its thread is gone so it can still be exported
+  thread_local std::shared_ptr<ThreadBuffer> tl_buffer;
+  if (tl_buffer == nullptr)
+  {
+    tl_buffer = std::make_shared<ThreadBuffer>();
+    tl_buffer->mEvents.resize(s_ThreadBufferCapacity);
+
+    QThread *l_thread = QThread::currentThread();
+    const bool l_isMainThread = QCoreApplication::instance() != nullptr && l_thread == QCoreApplication::instance()->thread();
+    tl_buffer->mThreadName = l_isMainThread ? QString("main") : l_thread->objectName();
+
+    QMutexLocker l_locker(&m_Lock);
+    tl_buffer->mThreadId = m_NextThreadId++;
+    if (tl_buffer->mThreadName.isEmpty())
+    {
+      tl_buffer->mThreadName = QString("thread %1").arg(tl_buffer->mThreadId);
+    }
+    m_Buffers.append(tl_buffer);
+  }
+  return *tl_buffer;
+}
+
+void Profiler::Record(const Event &t_event)
+{
+  ThreadBuffer &l_buffer = GetThreadBuffer();
+  const quint64 l_index = l_buffer.mWriteCount.load(std::memory_order_relaxed);
+  l_buffer.mEvents[l_index % l_buffer.mEvents.size()] = t_event;
+  l_buffer.mWriteCount.store(l_index + 1, std::memory_order_release);
+}
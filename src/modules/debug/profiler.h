@@ -0,0 +1,158 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/*!
+ * Scoped-zone profiler with Chrome trace-event export.
+ *
+ * Every thread records into its own fixed-size ring buffer. The owning thread
+ * is the only writer, so recording never takes a lock, and the oldest events
+ * are overwritten once a buffer is full. Event names must outlive the
+ * profiler, which string literals do; any other name goes through InternName.
+ */
+class Profiler
+{
+public:
+  Profiler(const Profiler&) = delete;
+
+  static Profiler& get()
+  {
+    return s_Instance;
+  }
+
+  enum class EventType
+  {
+    Zone,
+    Counter,
+    Mark,
+  };
+
+  struct Event
+  {
+    const char *mName = nullptr;
+    EventType mType = EventType::Zone;
+    qint64 mStart = 0;
+    qint64 mDuration = 0;
+    qint64 mValue = 0;
+    int mDepth = 0;
+  };
+
+  bool IsEnabled() const
+  {
+    return m_Enabled.load(std::memory_order_relaxed);
+  }
+  void SetEnabled(bool t_enabled);
+
+  // nanoseconds since the profiler was created
+  qint64 GetTimestamp() const;
+  const char *InternName(QString t_name);
+
+  // returns the nesting depth of the new zone on the calling thread
+  int EnterZone();
+  void LeaveZone();
+
+  void RecordZone(const char *t_name, qint64 t_start, qint64 t_end, int t_depth);
+  void RecordCounter(const char *t_name, qint64 t_value);
+  void RecordMark(const char *t_name);
+
+  bool ExportChromeTrace(QString t_filePath);
+  void Clear();
+
+private:
+  Profiler();
+  static Profiler s_Instance;
+
+  struct ThreadBuffer
+  {
+    quint64 mThreadId = 0;
+    QString mThreadName;
+    std::vector<Event> mEvents;
+    // number of events ever written; the next slot is mWriteCount % capacity
+    std::atomic<quint64> mWriteCount{0};
+    int mDepth = 0;
+  };
+
+  ThreadBuffer &GetThreadBuffer();
+  void Record(const Event &t_event);
+
+  std::atomic<bool> m_Enabled{false};
+  QElapsedTimer m_Clock;
+
+  QMutex m_Lock;
+  QVector<std::shared_ptr<ThreadBuffer>> m_Buffers = {};
+  QSet<QByteArray> m_InternedNames = {};
+  quint64 m_NextThreadId = 1;
+};
+
+/*!
+ * Records the lifetime of the enclosing scope as a zone.
+ */
+class ProfilerZone
+{
+public:
+  explicit ProfilerZone(const char *t_name)
+  {
+    Profiler &l_profiler = Profiler::get();
+    if (t_name == nullptr || !l_profiler.IsEnabled())
+    {
+      return;
+    }
+    m_Name = t_name;
+    m_Depth = l_profiler.EnterZone();
+    m_Start = l_profiler.GetTimestamp();
+  }
+
+  ~ProfilerZone()
+  {
+    if (m_Name == nullptr)
+    {
+      return;
+    }
+    Profiler &l_profiler = Profiler::get();
+    const qint64 l_end = l_profiler.GetTimestamp();
+    l_profiler.LeaveZone();
+    l_profiler.RecordZone(m_Name, m_Start, l_end, m_Depth);
+  }
+
+  ProfilerZone(const ProfilerZone&) = delete;
+  ProfilerZone &operator=(const ProfilerZone&) = delete;
+
+private:
+  const char *m_Name = nullptr;
+  qint64 m_Start = 0;
+  int m_Depth = 0;
+};
+
+#define DR_PROFILE_CONCAT_IMPL(a, b) a##b
+#define DR_PROFILE_CONCAT(a, b) DR_PROFILE_CONCAT_IMPL(a, b)
+
+#define DR_PROFILE_SCOPE(name) ProfilerZone DR_PROFILE_CONCAT(l_profilerZone, __LINE__)(name)
+#define DR_PROFILE_SCOPE_DYNAMIC(name) \
+  ProfilerZone DR_PROFILE_CONCAT(l_profilerZone, __LINE__)(Profiler::get().IsEnabled() ? Profiler::get().InternName(name) : nullptr)
+#define DR_PROFILE_FUNCTION() DR_PROFILE_SCOPE(Q_FUNC_INFO)
+
+#define DR_PROFILE_COUNTER(name, value) \
+  do \
+  { \
+    if (Profiler::get().IsEnabled()) \
+      Profiler::get().RecordCounter(name, value); \
+  } while (false)
+
+#define DR_PROFILE_MARK(name) \
+  do \
+  { \
+    if (Profiler::get().IsEnabled()) \
+      Profiler::get().RecordMark(name); \
+  } while (false)
+
+#endif // PROFILER_H
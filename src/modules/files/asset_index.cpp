@@ -0,0 +1,390 @@
+#include "asset_index.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+AssetIndex AssetIndex::s_Instance;
+
+namespace
+{
+// unwatched directories are compared against the disk at most this often
+constexpr qint64 s_RevalidateInterval = 2000;
+
+QString cleanAssetPath(const QString &t_path)
+{
+  return QDir::cleanPath(QDir::fromNativeSeparators(t_path));
+}
+
+// callers concatenate onto directory paths, so keep the separator they gave
+QString keepTrailingSeparator(const QString &t_path, QString t_resolvedPath)
+{
+  if (!t_resolvedPath.isEmpty() && (t_path.endsWith('/') || t_path.endsWith('\\')))
+  {
+    t_resolvedPath.append('/');
+  }
+  return t_resolvedPath;
+}
+
+QString joinPath(const QString &t_parentPath, const QString &t_name)
+{
+  return t_parentPath.isEmpty() ? t_name : t_parentPath + "/" + t_name;
+}
+} // namespace
+
+AssetIndex::AssetIndex()
+{
+  m_Clock.start();
+}
+
+void AssetIndex::SetMounts(QStringList t_rootList)
+{
+  QStringList l_watchList;
+  {
+    QMutexLocker l_locker(&m_Lock);
+    m_Mounts.clear();
+    m_PendingDirectories.clear();
+
+    for (const QString &i_root : qAsConst(t_rootList))
+    {
+      AssetMount l_mount;
+      l_mount.mRoot = cleanAssetPath(i_root);
+      if (QFileInfo(l_mount.mRoot).isDir())
+      {
+        l_watchList.append(IndexWatchedDirectories(l_mount));
+      }
+      m_Mounts.append(std::move(l_mount));
+    }
+  }
+
+  if (m_Watcher != nullptr)
+  {
+    const QStringList l_watchedList = m_Watcher->directories();
+    if (!l_watchedList.isEmpty())
+    {
+      m_Watcher->removePaths(l_watchedList);
+    }
+  }
+  WatchDirectories(l_watchList);
+}
+
+bool AssetIndex::IsMounted()
+{
+  QMutexLocker l_locker(&m_Lock);
+  return !m_Mounts.isEmpty();
+}
+
+std::optional<QString> AssetIndex::ResolveFile(QString t_path)
+{
+  return Resolve(t_path, true, false);
+}
+
+std::optional<QString> AssetIndex::ResolveDirectory(QString t_path)
+{
+  return Resolve(t_path, false, true);
+}
+
+std::optional<QString> AssetIndex::ResolvePath(QString t_path)
+{
+  return Resolve(t_path, true, true);
+}
+
+std::optional<QString> AssetIndex::FindFile(QString t_relativePath)
+{
+  return Find(t_relativePath, true, false);
+}
+
+std::optional<QString> AssetIndex::FindDirectory(QString t_relativePath)
+{
+  return Find(t_relativePath, false, true);
+}
+
+void AssetIndex::OnDirectoryChanged(const QString &t_path)
+{
+  // changes tend to come in bursts, e.g. while a package is being extracted
+  m_PendingDirectories.insert(t_path);
+  m_RefreshTimer->start();
+}
+
+void AssetIndex::ProcessPendingChanges()
+{
+  QStringList l_watchList;
+  {
+    QMutexLocker l_locker(&m_Lock);
+    const QSet<QString> l_directoryList = std::move(m_PendingDirectories);
+    m_PendingDirectories.clear();
+
+    for (const QString &i_directory : l_directoryList)
+    {
+      QString l_relativePath;
+      const int l_index = FindMount(cleanAssetPath(i_directory), l_relativePath);
+      if (l_index == -1)
+      {
+        continue;
+      }
+      AssetMount &l_mount = m_Mounts[l_index];
+
+      // new top-level directories have to be watched as well
+      if (l_relativePath.isEmpty())
+      {
+        l_watchList.append(IndexWatchedDirectories(l_mount));
+        continue;
+      }
+
+      // listed again on the next lookup through it
+      auto l_it = l_mount.mDirectories.find(l_relativePath.toLower());
+      if (l_it != l_mount.mDirectories.end())
+      {
+        l_it->mIndexed = false;
+      }
+    }
+  }
+  WatchDirectories(l_watchList);
+}
+
+AssetIndex::AssetDirectory *AssetIndex::GetDirectory(AssetMount &t_mount, const QString &t_key)
+{
+  auto l_it = t_mount.mDirectories.find(t_key);
+  if (l_it == t_mount.mDirectories.end())
+  {
+    return nullptr;
+  }
+
+  AssetDirectory &l_directory = *l_it;
+  if (!l_directory.mIndexed)
+  {
+    IndexDirectory(t_mount, l_directory);
+  }
+  else if (!l_directory.mWatched && m_Clock.elapsed() - l_directory.mCheckedAt >= s_RevalidateInterval)
+  {
+    RevalidateDirectory(t_mount, l_directory);
+  }
+  return &l_directory;
+}
+
+void AssetIndex::IndexDirectory(AssetMount &t_mount, AssetDirectory &t_directory)
+{
+  const QString l_directoryPath = t_directory.mPath.isEmpty() ? t_mount.mRoot : t_mount.mRoot + "/" + t_directory.mPath;
+  t_directory.mFiles.clear();
+  t_directory.mDirectories.clear();
+  t_directory.mModified = QFileInfo(l_directoryPath).lastModified();
+  t_directory.mCheckedAt = m_Clock.elapsed();
+  t_directory.mIndexed = true;
+
+  const QFileInfoList l_entryList = QDir(l_directoryPath).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+  for (const QFileInfo &i_entry : l_entryList)
+  {
+    const QString l_name = i_entry.fileName();
+    const QString l_key = l_name.toLower();
+    if (i_entry.isDir())
+    {
+      if (!t_directory.mDirectories.contains(l_key))
+      {
+        t_directory.mDirectories.insert(l_key, l_name);
+      }
+    }
+    else if (!t_directory.mFiles.contains(l_key))
+    {
+      t_directory.mFiles.insert(l_key, l_name);
+    }
+  }
+}
+
+void AssetIndex::RevalidateDirectory(AssetMount &t_mount, AssetDirectory &t_directory)
+{
+  // adding, removing or renaming an entry updates the modification time of its directory
+  t_directory.mCheckedAt = m_Clock.elapsed();
+  const QString l_directoryPath = t_directory.mPath.isEmpty() ? t_mount.mRoot : t_mount.mRoot + "/" + t_directory.mPath;
+  if (QFileInfo(l_directoryPath).lastModified() == t_directory.mModified)
+  {
+    return;
+  }
+  IndexDirectory(t_mount, t_directory);
+}
+
+QString AssetIndex::Lookup(AssetMount &t_mount, const QString &t_key, bool t_files, bool t_directories)
+{
+  const QStringList l_nameList = t_key.split('/');
+  QString l_parentKey;
+  for (int i = 0; i < l_nameList.length(); ++i)
+  {
+    const AssetDirectory *l_directory = GetDirectory(t_mount, l_parentKey);
+    if (l_directory == nullptr)
+    {
+      return QString{};
+    }
+
+    const QString &l_name = l_nameList.at(i);
+    if (i == l_nameList.length() - 1)
+    {
+      if (t_files && l_directory->mFiles.contains(l_name))
+      {
+        return joinPath(l_directory->mPath, l_directory->mFiles.value(l_name));
+      }
+      if (t_directories && l_directory->mDirectories.contains(l_name))
+      {
+        return joinPath(l_directory->mPath, l_directory->mDirectories.value(l_name));
+      }
+      return QString{};
+    }
+
+    const QString l_childName = l_directory->mDirectories.value(l_name);
+    if (l_childName.isEmpty())
+    {
+      return QString{};
+    }
+    const QString l_childPath = joinPath(l_directory->mPath, l_childName);
+    l_parentKey = joinPath(l_parentKey, l_name);
+
+    // inserting may move the parent, which is not used past this point
+    AssetDirectory &l_child = t_mount.mDirectories[l_parentKey];
+    if (l_child.mPath != l_childPath)
+    {
+      l_child.mPath = l_childPath;
+      l_child.mIndexed = false;
+    }
+  }
+  return QString{};
+}
+
+int AssetIndex::FindMount(const QString &t_path, QString &t_relativePath) const
+{
+  for (int i = 0; i < m_Mounts.length(); ++i)
+  {
+    const QString &l_root = m_Mounts.at(i).mRoot;
+    if (t_path.compare(l_root, Qt::CaseInsensitive) == 0)
+    {
+      t_relativePath.clear();
+      return i;
+    }
+
+    if (t_path.length() > l_root.length() && t_path.at(l_root.length()) == '/' && t_path.startsWith(l_root, Qt::CaseInsensitive))
+    {
+      t_relativePath = t_path.mid(l_root.length() + 1);
+      return i;
+    }
+  }
+  return -1;
+}
+
+std::optional<QString> AssetIndex::Resolve(QString t_path, bool t_files, bool t_directories)
+{
+  if (t_path.isEmpty())
+  {
+    return std::nullopt;
+  }
+
+  QMutexLocker l_locker(&m_Lock);
+  QString l_relativePath;
+  const int l_index = FindMount(cleanAssetPath(t_path), l_relativePath);
+  if (l_index == -1)
+  {
+    return std::nullopt;
+  }
+
+  AssetMount &l_mount = m_Mounts[l_index];
+  if (l_relativePath.isEmpty())
+  {
+    return t_directories ? keepTrailingSeparator(t_path, l_mount.mRoot) : QString{};
+  }
+
+  const QString l_key = l_relativePath.toLower();
+  if (t_files)
+  {
+    const QString l_filePath = Lookup(l_mount, l_key, true, false);
+    if (!l_filePath.isEmpty())
+    {
+      return l_mount.mRoot + "/" + l_filePath;
+    }
+  }
+
+  if (t_directories)
+  {
+    const QString l_directoryPath = Lookup(l_mount, l_key, false, true);
+    if (!l_directoryPath.isEmpty())
+    {
+      return keepTrailingSeparator(t_path, l_mount.mRoot + "/" + l_directoryPath);
+    }
+  }
+
+  return QString{};
+}
+
+std::optional<QString> AssetIndex::Find(QString t_relativePath, bool t_files, bool t_directories)
+{
+  QMutexLocker l_locker(&m_Lock);
+  if (m_Mounts.isEmpty())
+  {
+    return std::nullopt;
+  }
+
+  const QString l_key = cleanAssetPath(t_relativePath).toLower();
+  if (l_key.isEmpty())
+  {
+    return QString{};
+  }
+
+  // highest precedence first
+  for (AssetMount &i_mount : m_Mounts)
+  {
+    const QString l_path = Lookup(i_mount, l_key, t_files, t_directories);
+    if (!l_path.isEmpty())
+    {
+      const QString l_absolutePath = i_mount.mRoot + "/" + l_path;
+      return t_files ? l_absolutePath : keepTrailingSeparator(t_relativePath, l_absolutePath);
+    }
+  }
+  return QString{};
+}
+
+// lists the root right away and marks it and its top-level directories as watched; returns their paths
+QStringList AssetIndex::IndexWatchedDirectories(AssetMount &t_mount)
+{
+  AssetDirectory &l_root = t_mount.mDirectories[QString{}];
+  l_root.mWatched = true;
+  IndexDirectory(t_mount, l_root);
+  const QHash<QString, QString> l_topLevelList = l_root.mDirectories;
+
+  QStringList l_watchList{t_mount.mRoot};
+  for (auto it = l_topLevelList.cbegin(); it != l_topLevelList.cend(); ++it)
+  {
+    // the watcher forgets directories once they are removed, so their listing may be stale
+    AssetDirectory &l_directory = t_mount.mDirectories[it.key()];
+    l_directory.mPath = it.value();
+    l_directory.mWatched = true;
+    l_directory.mIndexed = false;
+    l_watchList.append(t_mount.mRoot + "/" + it.value());
+  }
+  return l_watchList;
+}
+
+void AssetIndex::WatchDirectories(const QStringList &t_directoryList)
+{
+  if (m_Watcher == nullptr)
+  {
+    // owned by the application so that they are gone before static teardown
+    m_Watcher = new QFileSystemWatcher(QCoreApplication::instance());
+    connect(m_Watcher, &QFileSystemWatcher::directoryChanged, this, &AssetIndex::OnDirectoryChanged);
+
+    m_RefreshTimer = new QTimer(QCoreApplication::instance());
+    m_RefreshTimer->setSingleShot(true);
+    m_RefreshTimer->setInterval(250);
+    connect(m_RefreshTimer, &QTimer::timeout, this, &AssetIndex::ProcessPendingChanges);
+  }
+
+  const QStringList l_watchedList = m_Watcher->directories();
+  QStringList l_newList;
+  for (const QString &i_directory : t_directoryList)
+  {
+    if (!l_watchedList.contains(i_directory))
+    {
+      l_newList.append(i_directory);
+    }
+  }
+
+  if (!l_newList.isEmpty())
+  {
+    m_Watcher->addPaths(l_newList);
+  }
+}
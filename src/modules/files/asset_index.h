@@ -0,0 +1,103 @@
+#ifndef ASSETINDEX_H
+#define ASSETINDEX_H
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+#include <optional>
+
+/*!
+ * In-memory index of every mounted asset root (base and enabled packages).
+ *
+ * Paths are matched case-insensitively, and higher mounts take precedence
+ * over lower ones. Directories are listed one level at a time, on the first
+ * lookup that needs them, so asset lookups rarely touch the disk.
+ *
+ * Only the mount roots and their top-level directories are watched. Any
+ * deeper directory is checked against its modification time, at most once
+ * per revalidation interval.
+ */
+class AssetIndex : public QObject
+{
+  Q_OBJECT
+public:
+  AssetIndex(const AssetIndex&) = delete;
+
+  static AssetIndex& get()
+  {
+    return s_Instance;
+  }
+
+  // roots are given from highest to lowest precedence
+  void SetMounts(QStringList t_rootList);
+  bool IsMounted();
+
+  // absolute paths; nullopt when the path is outside every mounted root,
+  // an empty string when it does not exist
+  std::optional<QString> ResolveFile(QString t_path);
+  std::optional<QString> ResolveDirectory(QString t_path);
+  std::optional<QString> ResolvePath(QString t_path);
+
+  // relative paths, resolved against the overlay of all mounted roots
+  std::optional<QString> FindFile(QString t_relativePath);
+  std::optional<QString> FindDirectory(QString t_relativePath);
+
+private slots:
+  void OnDirectoryChanged(const QString &t_path);
+  void ProcessPendingChanges();
+
+private:
+  AssetIndex();
+  static AssetIndex s_Instance;
+
+  struct AssetDirectory
+  {
+    // relative path as found on disk
+    QString mPath;
+    // lowercase entry name -> entry name as found on disk
+    QHash<QString, QString> mFiles;
+    QHash<QString, QString> mDirectories;
+    bool mIndexed = false;
+    // watched directories are kept fresh by the watcher instead
+    bool mWatched = false;
+    QDateTime mModified;
+    qint64 mCheckedAt = 0;
+  };
+
+  struct AssetMount
+  {
+    QString mRoot;
+    // lowercase relative path -> directory; the root is under the empty key
+    QHash<QString, AssetDirectory> mDirectories;
+  };
+
+  AssetDirectory *GetDirectory(AssetMount &t_mount, const QString &t_key);
+  void IndexDirectory(AssetMount &t_mount, AssetDirectory &t_directory);
+  void RevalidateDirectory(AssetMount &t_mount, AssetDirectory &t_directory);
+  // relative path as found on disk, or an empty string
+  QString Lookup(AssetMount &t_mount, const QString &t_key, bool t_files, bool t_directories);
+  int FindMount(const QString &t_path, QString &t_relativePath) const;
+  std::optional<QString> Resolve(QString t_path, bool t_files, bool t_directories);
+  std::optional<QString> Find(QString t_relativePath, bool t_files, bool t_directories);
+  QStringList IndexWatchedDirectories(AssetMount &t_mount);
+  void WatchDirectories(const QStringList &t_directoryList);
+
+  QMutex m_Lock;
+  QElapsedTimer m_Clock;
+  QVector<AssetMount> m_Mounts = {};
+
+  QFileSystemWatcher *m_Watcher = nullptr;
+  QTimer *m_RefreshTimer = nullptr;
+  QSet<QString> m_PendingDirectories = {};
+};
+
+#endif // ASSETINDEX_H
@@ -0,0 +1,191 @@
+#include "ini_cache.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QTextStream>
+
+IniCache IniCache::s_Instance;
+
+IniDocument::IniDocument(const QStringList &t_lineList)
+{
+  QStringList *l_section = nullptr;
+  for (const QString &i_line : t_lineList)
+  {
+    if (i_line.startsWith("[") && i_line.endsWith("]"))
+    {
+      const QString l_header = i_line.toLower();
+      l_section = mSections.contains(l_header) ? nullptr : &mSections[l_header];
+      continue;
+    }
+
+    if (l_section != nullptr)
+    {
+      l_section->append(i_line);
+    }
+
+    const QStringList l_elementList = i_line.trimmed().split("=");
+    if (l_elementList.length() < 2)
+    {
+      continue;
+    }
+
+    const QString l_key = l_elementList.at(0).trimmed();
+    if (!mValues.contains(l_key))
+    {
+      mValues.insert(l_key, l_elementList.at(1).trimmed());
+    }
+  }
+}
+
+QString IniDocument::GetValue(const QString &t_key) const
+{
+  return mValues.value(t_key);
+}
+
+QStringList IniDocument::GetSectionLines(const QString &t_header) const
+{
+  return mSections.value(t_header.toLower());
+}
+
+IniSettings::IniSettings(const QString &t_path)
+{
+  QSettings l_settings(t_path, QSettings::IniFormat);
+  l_settings.setIniCodec("UTF-8");
+
+  QStringList l_groupList = l_settings.childGroups();
+  l_groupList.prepend(QString{});
+  for (const QString &i_group : qAsConst(l_groupList))
+  {
+    const QString l_sectionName = i_group.toLower();
+    if (!i_group.isEmpty() && mSections.contains(l_sectionName))
+    {
+      continue;
+    }
+
+    QHash<QString, QVariant> &l_section = mSections[l_sectionName];
+    l_settings.beginGroup(i_group);
+    for (const QString &i_key : l_settings.childKeys())
+    {
+      const QString l_key = i_key.toLower();
+      if (!l_section.contains(l_key))
+      {
+        l_section.insert(l_key, l_settings.value(i_key));
+      }
+    }
+    l_settings.endGroup();
+  }
+}
+
+QVariant IniSettings::GetValue(const QString &t_section, const QString &t_key, const QVariant &t_default) const
+{
+  const auto l_section = mSections.constFind(t_section.toLower());
+  if (l_section == mSections.cend())
+  {
+    return t_default;
+  }
+  return l_section->value(t_key.toLower(), t_default);
+}
+
+std::shared_ptr<const IniDocument> IniCache::GetDocument(const QString &t_path)
+{
+  FileStamp l_stamp;
+  if (!ReadStamp(t_path, l_stamp))
+  {
+    return nullptr;
+  }
+
+  {
+    QMutexLocker l_locker(&m_Lock);
+    const auto l_entry = m_Documents.constFind(t_path);
+    if (l_entry != m_Documents.cend() && l_entry->mStamp == l_stamp)
+    {
+      ++m_Statistics.hits;
+      return l_entry->mData;
+    }
+  }
+
+  QFile l_file(t_path);
+  if (!l_file.open(QIODevice::ReadOnly))
+  {
+    return nullptr;
+  }
+
+  QStringList l_lineList;
+  QTextStream l_in(&l_file);
+  while (!l_in.atEnd())
+  {
+    l_lineList.append(l_in.readLine());
+  }
+  l_file.close();
+
+  std::shared_ptr<const IniDocument> l_document = std::make_shared<const IniDocument>(l_lineList);
+  QMutexLocker l_locker(&m_Lock);
+  ++m_Statistics.misses;
+  m_Documents.insert(t_path, CacheEntry<IniDocument>{l_stamp, l_document});
+  return l_document;
+}
+
+std::shared_ptr<const IniSettings> IniCache::GetSettings(const QString &t_path)
+{
+  FileStamp l_stamp;
+  if (!ReadStamp(t_path, l_stamp))
+  {
+    return nullptr;
+  }
+
+  {
+    QMutexLocker l_locker(&m_Lock);
+    const auto l_entry = m_Settings.constFind(t_path);
+    if (l_entry != m_Settings.cend() && l_entry->mStamp == l_stamp)
+    {
+      ++m_Statistics.hits;
+      return l_entry->mData;
+    }
+  }
+
+  std::shared_ptr<const IniSettings> l_settings = std::make_shared<const IniSettings>(t_path);
+  QMutexLocker l_locker(&m_Lock);
+  ++m_Statistics.misses;
+  m_Settings.insert(t_path, CacheEntry<IniSettings>{l_stamp, l_settings});
+  return l_settings;
+}
+
+IniCache::Statistics IniCache::GetStatistics()
+{
+  QMutexLocker l_locker(&m_Lock);
+  return m_Statistics;
+}
+
+void IniCache::ResetStatistics()
+{
+  QMutexLocker l_locker(&m_Lock);
+  m_Statistics = Statistics{};
+}
+
+void IniCache::Clear()
+{
+  QMutexLocker l_locker(&m_Lock);
+  m_Documents.clear();
+  m_Settings.clear();
+}
+
+bool IniCache::ReadStamp(const QString &t_path, FileStamp &t_stamp)
+{
+  if (t_path.isEmpty())
+  {
+    return false;
+  }
+
+  const QFileInfo l_fileInfo(t_path);
+  if (!l_fileInfo.isFile())
+  {
+    return false;
+  }
+
+  t_stamp.mModified = l_fileInfo.lastModified().toMSecsSinceEpoch();
+  t_stamp.mSize = l_fileInfo.size();
+  return true;
+}
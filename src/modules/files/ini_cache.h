@@ -0,0 +1,105 @@
+#ifndef INICACHE_H
+#define INICACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+#include <memory>
+
+/*!
+ * A plain-text ini file, parsed once.
+ *
+ * Keeps the first value of every key regardless of its section, which is what
+ * the theme files are looked up by, and the raw lines of every section, which
+ * is what the stylesheet and highlight readers consume.
+ */
+class IniDocument
+{
+public:
+  explicit IniDocument(const QStringList &t_lineList);
+
+  QString GetValue(const QString &t_key) const;
+  // header including the brackets, case-insensitive
+  QStringList GetSectionLines(const QString &t_header) const;
+
+private:
+  QHash<QString, QString> mValues;
+  QHash<QString, QStringList> mSections;
+};
+
+/*!
+ * An ini file as parsed by QSettings, with lowercase section and key names.
+ */
+class IniSettings
+{
+public:
+  explicit IniSettings(const QString &t_path);
+
+  QVariant GetValue(const QString &t_section, const QString &t_key, const QVariant &t_default) const;
+
+private:
+  QHash<QString, QHash<QString, QVariant>> mSections;
+};
+
+/*!
+ * Process-wide cache of parsed ini files, keyed by path and invalidated when
+ * the modification time or the size of the file changes.
+ */
+class IniCache
+{
+public:
+  struct Statistics
+  {
+    quint64 hits = 0;
+    quint64 misses = 0;
+  };
+
+  IniCache(const IniCache&) = delete;
+
+  static IniCache& get()
+  {
+    return s_Instance;
+  }
+
+  // nullptr when the file cannot be read
+  std::shared_ptr<const IniDocument> GetDocument(const QString &t_path);
+  std::shared_ptr<const IniSettings> GetSettings(const QString &t_path);
+
+  Statistics GetStatistics();
+  void ResetStatistics();
+  void Clear();
+
+private:
+  IniCache() {}
+  static IniCache s_Instance;
+
+  struct FileStamp
+  {
+    qint64 mModified = 0;
+    qint64 mSize = -1;
+
+    bool operator==(const FileStamp &t_other) const
+    {
+      return mModified == t_other.mModified && mSize == t_other.mSize;
+    }
+  };
+
+  template <typename T>
+  struct CacheEntry
+  {
+    FileStamp mStamp;
+    std::shared_ptr<const T> mData;
+  };
+
+  static bool ReadStamp(const QString &t_path, FileStamp &t_stamp);
+
+  QMutex m_Lock;
+  QHash<QString, CacheEntry<IniDocument>> m_Documents = {};
+  QHash<QString, CacheEntry<IniSettings>> m_Settings = {};
+  Statistics m_Statistics = {};
+};
+
+#endif // INICACHE_H
@@ -7,27 +7,51 @@ ReplayReader::ReplayReader(QString t_path)
   QString l_filePath = t_path;
   if(file_exists(l_filePath))
   {
-    ReadFromFile(l_filePath);
+    QFile l_replayFile(l_filePath);
+    if(!l_replayFile.open(QIODevice::ReadOnly)) return;
+    const QByteArray l_replayData = l_replayFile.readAll();
+    l_replayFile.close();
 
-    QJsonArray l_scriptOperationsArray = getArrayValue("script");
-    for(QJsonValueRef r_operation : l_scriptOperationsArray)
+    QJsonParseError l_parseError;
+    mDocument = QJsonDocument::fromJson(l_replayData, &l_parseError);
+    if(l_parseError.error == QJsonParseError::NoError && mDocument.isObject() && mDocument.object().contains("script"))
     {
-      SetTargetObject(r_operation.toObject());
-
-      ReplayOperation l_operation(getStringValue("op"));
-      l_operation.mTimestamp = getIntValue("time");
-      QStringList l_keys = r_operation.toObject().keys();
-
-      for(QString l_operationKey : l_keys)
+      mMainObject = mDocument.object();
+      mTargetObject = mMainObject;
+      QJsonArray l_scriptOperationsArray = getArrayValue("script");
+      for(QJsonValueRef r_operation : l_scriptOperationsArray)
       {
-        l_operation.mVariables[l_operationKey] = getStringValue(l_operationKey);
+        ReadOperation(r_operation.toObject());
       }
+      return;
+    }
 
-      mCachedOperations.append(l_operation);
+    // recordings that were never finalized are a journal of one operation per line
+    for(const QByteArray &r_line : l_replayData.split('\n'))
+    {
+      const QJsonDocument l_lineDocument = QJsonDocument::fromJson(r_line);
+      if(!l_lineDocument.isObject()) continue;
+      ReadOperation(l_lineDocument.object());
     }
   }
 }
 
+void ReplayReader::ReadOperation(QJsonObject t_operation)
+{
+  SetTargetObject(t_operation);
+
+  ReplayOperation l_operation(getStringValue("op"));
+  l_operation.mTimestamp = getIntValue("time");
+  QStringList l_keys = t_operation.keys();
+
+  for(QString l_operationKey : l_keys)
+  {
+    l_operation.mVariables[l_operationKey] = getStringValue(l_operationKey);
+  }
+
+  mCachedOperations.append(l_operation);
+}
+
 QVector<ReplayOperation> ReplayReader::getOperations()
 {
   return mCachedOperations;
@@ -13,6 +13,8 @@ public:
   QVector<ReplayOperation> getOperations();
 
 private:
+  void ReadOperation(QJsonObject t_operation);
+
   QVector<ReplayOperation> mCachedOperations   = {};
 };
 
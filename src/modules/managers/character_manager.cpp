@@ -6,7 +6,9 @@
 
 #include <aoapplication.h>
 #include <QCheckBox>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
 #include "courtroom.h"
 #include "qmath.h"
 #include <QTextStream>
@@ -19,21 +21,61 @@
 CharacterManager CharacterManager::s_Instance;
 
 
-CharacterData *CharacterManager::ReadCharacter(QString t_folder)
+namespace
 {
-  QString l_jsonPath = AOApplication::getInstance()->get_character_path(t_folder, "char.json");
-  if(file_exists(l_jsonPath))
+// identifies the files a parsed character depends on, so edits are picked up
+QString characterStamp(const QString &t_definitionPath, const QString &t_folderPath)
+{
+  const QFileInfo l_definitionInfo(t_definitionPath);
+  const QFileInfo l_outfitsInfo(t_folderPath + "/outfits");
+  return QString("%1|%2|%3|%4")
+      .arg(t_definitionPath)
+      .arg(l_definitionInfo.lastModified().toMSecsSinceEpoch())
+      .arg(l_definitionInfo.size())
+      .arg(l_outfitsInfo.lastModified().toMSecsSinceEpoch());
+}
+} // namespace
+
+CharacterData::ptr CharacterManager::ReadCharacter(QString t_folder)
+{
+  AOApplication *l_app = AOApplication::getInstance();
+
+  // the resolved folder tells apart the same character in different packages
+  const QString l_folderPath = l_app->get_character_folder_path(t_folder);
+  const QString l_jsonPath = l_app->get_character_path(t_folder, "char.json");
+  const bool l_isJson = file_exists(l_jsonPath);
+  const QString l_stamp = characterStamp(l_isJson ? l_jsonPath : l_app->get_character_path(t_folder, CHARACTER_CHAR_INI), l_folderPath);
+
+  const auto l_cached = mCharacterCache.constFind(l_folderPath);
+  if(l_cached != mCharacterCache.cend() && l_cached->mStamp == l_stamp)
   {
-    CharacterData *l_returnData = new CharacterDataReader();
-    l_returnData->loadCharacter(t_folder);
-    return l_returnData;
+    mCharacterCacheOrder.removeOne(l_folderPath);
+    mCharacterCacheOrder.prepend(l_folderPath);
+    return l_cached->mData;
   }
 
-  CharacterData *l_returnData = new LegacyCharacterReader();
+  CharacterData::ptr l_returnData;
+  if(l_isJson) l_returnData.reset(new CharacterDataReader());
+  else l_returnData.reset(new LegacyCharacterReader());
   l_returnData->loadCharacter(t_folder);
+
+  mCharacterCache.insert(l_folderPath, {l_stamp, l_returnData});
+  mCharacterCacheOrder.removeOne(l_folderPath);
+  mCharacterCacheOrder.prepend(l_folderPath);
+  while(mCharacterCacheOrder.length() > mCharacterCacheCapacity)
+  {
+    mCharacterCache.remove(mCharacterCacheOrder.takeLast());
+  }
+
   return l_returnData;
 }
 
+void CharacterManager::ClearCharacterCache()
+{
+  mCharacterCache.clear();
+  mCharacterCacheOrder.clear();
+}
+
 void CharacterManager::SwitchCharacter(QString t_folder)
 {
   QString l_jsonPath = AOApplication::getInstance()->get_character_path(t_folder, "char.json");
@@ -43,7 +85,7 @@ void CharacterManager::SwitchCharacter(QString t_folder)
 
   if(file_exists(l_jsonPath))
   {
-    p_SelectedCharacter = new CharacterDataReader();
+    p_SelectedCharacter.reset(new CharacterDataReader());
     p_SelectedCharacter->loadCharacter(t_folder);
     QStringList l_charaOutfits = p_SelectedCharacter->getOutfitNames();
     l_OutfitNames.append(l_charaOutfits);
@@ -51,7 +93,7 @@ void CharacterManager::SwitchCharacter(QString t_folder)
     return;
   }
 
-  p_SelectedCharacter = new LegacyCharacterReader();
+  p_SelectedCharacter.reset(new LegacyCharacterReader());
   p_SelectedCharacter->loadCharacter(t_folder);
   setOutfitList(l_OutfitNames);
   return;
@@ -152,6 +194,7 @@ QString CharacterManager::GetServerCharaName(int id)
 
 void CharacterManager::ResetPackages()
 {
+  ClearCharacterCache();
   lastCharList = "Server Characters";
   mPackageCharacters = {};
   mCharacterPackages.clear();
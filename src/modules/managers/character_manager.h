@@ -13,9 +13,11 @@ class CharacterManager
 public:
   CharacterManager(const CharacterManager&) = delete;
 
-  CharacterData *p_SelectedCharacter = nullptr;
+  CharacterData::ptr p_SelectedCharacter = nullptr;
 
-  CharacterData *ReadCharacter(QString t_folder);
+  // parsed characters are shared and kept until their files change
+  CharacterData::ptr ReadCharacter(QString t_folder);
+  void ClearCharacterCache();
   void SwitchCharacter(QString t_folder);
 
 
@@ -73,6 +75,17 @@ private:
   QStringList mCharacterPackages = {"Server Characters", "Favorites", "All"};
   QStringList mCharacterOutfits = {};
 
+  struct CachedCharacter
+  {
+    QString mStamp;
+    CharacterData::ptr mData;
+  };
+
+  const int mCharacterCacheCapacity = 64;
+  QHash<QString, CachedCharacter> mCharacterCache = {};
+  // most recently used first
+  QStringList mCharacterCacheOrder = {};
+
 };
 
 #endif // CHARACTERMANAGER_H
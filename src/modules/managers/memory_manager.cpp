@@ -0,0 +1,174 @@
+#include "memory_manager.h"
+
+#include "modules/debug/profiler.h"
+
+#include <QMutexLocker>
+#include <QVector>
+
+#if defined(Q_OS_WINDOWS)
+#include <Windows.h>
+#include <sysinfoapi.h>
+#elif defined(Q_OS_LINUX)
+#include <sys/sysinfo.h>
+#elif defined(Q_OS_MAC)
+#include <sys/sysctl.h>
+#include <sys/types.h>
+#else
+#error Unsupported platform.
+#endif
+
+MemoryManager MemoryManager::s_Instance;
+
+qint64 MemoryManager::GetPhysicalMemory()
+{
+#if defined(Q_OS_WINDOWS)
+  MEMORYSTATUSEX l_memoryStatus;
+  l_memoryStatus.dwLength = sizeof(MEMORYSTATUSEX);
+  if (GlobalMemoryStatusEx(&l_memoryStatus))
+  {
+    return qint64(l_memoryStatus.ullTotalPhys);
+  }
+#elif defined(Q_OS_LINUX)
+  struct sysinfo l_sysInfo;
+  if (sysinfo(&l_sysInfo) != -1)
+  {
+    return qint64(l_sysInfo.totalram) * l_sysInfo.mem_unit;
+  }
+#elif defined(Q_OS_MAC)
+  int64_t l_memorySize = 0;
+  size_t l_length = sizeof(l_memorySize);
+  if (sysctlbyname("hw.memsize", &l_memorySize, &l_length, nullptr, 0) == 0)
+  {
+    return qint64(l_memorySize);
+  }
+#endif
+  return 0;
+}
+
+qint64 MemoryManager::GetProcessCap()
+{
+  QMutexLocker l_locker(&m_Lock);
+  return m_ProcessCap;
+}
+
+void MemoryManager::SetProcessCap(qint64 t_bytes)
+{
+  {
+    QMutexLocker l_locker(&m_Lock);
+    m_ProcessCap = qMax(0ll, t_bytes);
+  }
+  // anything above the new cap that can be given back is
+  EnsureHeadroom(0, Priority::Active);
+}
+
+void MemoryManager::SetProcessCapPercent(int t_percent)
+{
+  qint64 l_physicalMemory = GetPhysicalMemory();
+  if (l_physicalMemory <= 0)
+  {
+    l_physicalMemory = 4096ll * 1024 * 1024;
+  }
+  SetProcessCap(l_physicalMemory / 100 * qBound(0, t_percent, 100));
+}
+
+int MemoryManager::RegisterConsumer(QString t_name, Priority t_priority, EvictFunction t_evict)
+{
+  Consumer l_consumer;
+  l_consumer.mName = t_name;
+  l_consumer.mPriority = t_priority;
+  l_consumer.mEvict = std::move(t_evict);
+  l_consumer.mCounterName = Profiler::get().InternName("memory " + t_name);
+
+  QMutexLocker l_locker(&m_Lock);
+  const int l_id = m_NextId++;
+  m_Consumers.insert(l_id, std::move(l_consumer));
+  return l_id;
+}
+
+void MemoryManager::UnregisterConsumer(int t_id)
+{
+  QMutexLocker l_locker(&m_Lock);
+  const Consumer l_consumer = m_Consumers.take(t_id);
+  m_Usage -= l_consumer.mUsage;
+}
+
+void MemoryManager::SetUsage(int t_id, qint64 t_bytes)
+{
+  QMutexLocker l_locker(&m_Lock);
+  auto l_it = m_Consumers.find(t_id);
+  if (l_it == m_Consumers.end())
+  {
+    return;
+  }
+  m_Usage += t_bytes - l_it->mUsage;
+  l_it->mUsage = t_bytes;
+  RecordUsage(*l_it);
+}
+
+void MemoryManager::AddUsage(int t_id, qint64 t_bytes)
+{
+  QMutexLocker l_locker(&m_Lock);
+  auto l_it = m_Consumers.find(t_id);
+  if (l_it == m_Consumers.end())
+  {
+    return;
+  }
+  l_it->mUsage += t_bytes;
+  m_Usage += t_bytes;
+  RecordUsage(*l_it);
+}
+
+qint64 MemoryManager::GetUsage()
+{
+  QMutexLocker l_locker(&m_Lock);
+  return m_Usage;
+}
+
+qint64 MemoryManager::GetUsage(int t_id)
+{
+  QMutexLocker l_locker(&m_Lock);
+  return m_Consumers.value(t_id).mUsage;
+}
+
+bool MemoryManager::EnsureHeadroom(qint64 t_bytes, Priority t_priority)
+{
+  for (int i = int(Priority::Speculative); i < int(t_priority); ++i)
+  {
+    QVector<EvictFunction> l_evictList;
+    qint64 l_excess = 0;
+    {
+      QMutexLocker l_locker(&m_Lock);
+      l_excess = m_Usage + t_bytes - m_ProcessCap;
+      if (l_excess <= 0)
+      {
+        return true;
+      }
+      for (const Consumer &i_consumer : qAsConst(m_Consumers))
+      {
+        if (int(i_consumer.mPriority) == i && i_consumer.mEvict && i_consumer.mUsage > 0)
+        {
+          l_evictList.append(i_consumer.mEvict);
+        }
+      }
+    }
+
+    // consumers report what they released through SetUsage and AddUsage
+    for (const EvictFunction &i_evict : qAsConst(l_evictList))
+    {
+      l_excess -= i_evict(l_excess);
+      if (l_excess <= 0)
+      {
+        break;
+      }
+    }
+  }
+
+  QMutexLocker l_locker(&m_Lock);
+  return m_Usage + t_bytes <= m_ProcessCap;
+}
+
+void MemoryManager::RecordUsage(const Consumer &t_consumer)
+{
+  DR_PROFILE_COUNTER(t_consumer.mCounterName, t_consumer.mUsage);
+  DR_PROFILE_COUNTER("memory total", m_Usage);
+}
@@ -0,0 +1,87 @@
+#ifndef MEMORYMANAGER_H
+#define MEMORYMANAGER_H
+
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+#include <functional>
+
+/*!
+ * Process-wide memory budget.
+ *
+ * Every large consumer registers once and reports the bytes it actually
+ * holds. Before a consumer grows by a known amount it makes headroom for it;
+ * consumers of a lower priority are asked to give memory back until the
+ * process fits under its cap again. Eviction callbacks run on the calling
+ * thread without the budget's lock held.
+ *
+ * Headroom is not set aside: concurrent callers may each be told the same
+ * bytes fit, so the cap is a target rather than a hard limit.
+ */
+class MemoryManager
+{
+public:
+  MemoryManager(const MemoryManager&) = delete;
+
+  static MemoryManager& get()
+  {
+    return s_Instance;
+  }
+
+  // consumers are evicted lowest priority first
+  enum class Priority
+  {
+    Speculative,
+    Cached,
+    Active,
+  };
+
+  // releases up to the given number of bytes and returns how many it released
+  using EvictFunction = std::function<qint64(qint64)>;
+
+  // installed physical memory; 0 when it cannot be determined
+  static qint64 GetPhysicalMemory();
+
+  qint64 GetProcessCap();
+  void SetProcessCap(qint64 t_bytes);
+  // share of the physical memory; an assumed 4 GiB when that is unknown
+  void SetProcessCapPercent(int t_percent);
+
+  int RegisterConsumer(QString t_name, Priority t_priority, EvictFunction t_evict = nullptr);
+  void UnregisterConsumer(int t_id);
+
+  void SetUsage(int t_id, qint64 t_bytes);
+  void AddUsage(int t_id, qint64 t_bytes);
+
+  qint64 GetUsage();
+  qint64 GetUsage(int t_id);
+
+  // returns whether the bytes fit under the cap once lower priority consumers have been evicted;
+  // nothing is held back for the caller until it reports the usage itself
+  bool EnsureHeadroom(qint64 t_bytes, Priority t_priority);
+
+private:
+  MemoryManager() {}
+  static MemoryManager s_Instance;
+
+  struct Consumer
+  {
+    QString mName;
+    Priority mPriority = Priority::Cached;
+    EvictFunction mEvict;
+    qint64 mUsage = 0;
+    const char *mCounterName = nullptr;
+  };
+
+  // must be called with the lock held
+  void RecordUsage(const Consumer &t_consumer);
+
+  QMutex m_Lock;
+  QMap<int, Consumer> m_Consumers = {};
+  int m_NextId = 1;
+  qint64 m_Usage = 0;
+  qint64 m_ProcessCap = 2048ll * 1024 * 1024;
+};
+
+#endif // MEMORYMANAGER_H
@@ -3,6 +3,7 @@
 #include "character_manager.h"
 #include "commondefs.h"
 #include "replay_manager.h"
+#include "modules/files/asset_index.h"
 
 
 PathingManager PathingManager::s_Instance;
@@ -36,6 +37,11 @@ QString PathingManager::searchFirstFile(QString t_file)
 
 QString PathingManager::searchFirstDirectory(QString t_directory)
 {
+  if (const std::optional<QString> lIndexedPath = AssetIndex::get().FindDirectory(t_directory))
+  {
+    return lIndexedPath->isEmpty() ? getBasePath() + t_directory : lIndexedPath.value();
+  }
+
   for (QString r_PackageName : m_PackagesLocal)
   {
     if(!m_PackagesDisabled.contains(r_PackageName))
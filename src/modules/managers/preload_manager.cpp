@@ -0,0 +1,224 @@
+#include "preload_manager.h"
+
+#include "aoapplication.h"
+#include "mk2/spritecache.h"
+#include "mk2/spritecachingreader.h"
+#include "modules/debug/profiler.h"
+#include "modules/managers/memory_manager.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QImageReader>
+
+#include <algorithm>
+
+PreloadManager PreloadManager::s_Instance;
+
+namespace
+{
+constexpr int s_MaxSpeakers = 5;
+constexpr int s_EmotesPerSpeaker = 2;
+constexpr int s_QuietDelay = 1500;
+} // namespace
+
+qint64 PreloadManager::GetByteBudget()
+{
+  return m_ByteBudget;
+}
+
+void PreloadManager::SetByteBudget(qint64 t_bytes)
+{
+  m_ByteBudget = qMax(0ll, t_bytes);
+  if (m_ByteBudget == 0)
+  {
+    CancelWarmUp();
+  }
+}
+
+void PreloadManager::ResetHistory()
+{
+  CancelWarmUp();
+  m_Speakers.clear();
+  m_PredictedFiles.clear();
+}
+
+void PreloadManager::RecordMessage(QString t_character, QString t_emote)
+{
+  if (m_WarmUpTimer != nullptr)
+  {
+    m_WarmUpTimer->stop();
+  }
+
+  // hits are only counted while something was predicted
+  const QStringList l_fileList = GetSpriteFiles(t_character, t_emote);
+  QHash<QString, mk2::SpriteReader::ptr> l_hitReaders;
+  if (!m_PredictedFiles.isEmpty())
+  {
+    for (const QString &i_file : l_fileList)
+    {
+      if (m_PredictedFiles.contains(i_file))
+      {
+        ++m_HitCount;
+      }
+      else
+      {
+        ++m_MissCount;
+      }
+    }
+    RecordStatistics();
+  }
+
+  // the message readers attach to the decodes it needs; everything else gives the decoder back at once
+  for (const QString &i_file : l_fileList)
+  {
+    mk2::SpriteReader::ptr l_reader = m_WarmReaders.take(i_file);
+    if (l_reader)
+    {
+      l_reader->set_decode_priority(mk2::SpriteDecodeScheduler::Priority::NextMessage);
+      l_hitReaders.insert(i_file, l_reader);
+    }
+  }
+  m_WarmReaders = std::move(l_hitReaders);
+  m_PredictedFiles.clear();
+
+  if (t_character.isEmpty() || t_emote.isEmpty())
+  {
+    return;
+  }
+
+  auto l_it = std::find_if(m_Speakers.begin(), m_Speakers.end(), [&t_character](const SpeakerHistory &t_speaker) {
+    return t_speaker.mCharacter == t_character;
+  });
+  SpeakerHistory l_speaker;
+  if (l_it != m_Speakers.end())
+  {
+    l_speaker = *l_it;
+    m_Speakers.erase(l_it);
+  }
+  l_speaker.mCharacter = t_character;
+  l_speaker.mLastEmote = t_emote;
+  ++l_speaker.mEmoteUsage[t_emote];
+  m_Speakers.prepend(l_speaker);
+  while (m_Speakers.length() > s_MaxSpeakers)
+  {
+    m_Speakers.removeLast();
+  }
+}
+
+void PreloadManager::ScheduleWarmUp()
+{
+  if (m_ByteBudget == 0 || m_Speakers.isEmpty())
+  {
+    return;
+  }
+
+  if (m_WarmUpTimer == nullptr)
+  {
+    // owned by the application so that it is gone before static teardown
+    m_WarmUpTimer = new QTimer(QCoreApplication::instance());
+    m_WarmUpTimer->setSingleShot(true);
+    m_WarmUpTimer->setInterval(s_QuietDelay);
+    connect(m_WarmUpTimer, &QTimer::timeout, this, &PreloadManager::StartWarmUp);
+  }
+  m_WarmUpTimer->start();
+}
+
+void PreloadManager::CancelWarmUp()
+{
+  if (m_WarmUpTimer != nullptr)
+  {
+    m_WarmUpTimer->stop();
+  }
+  m_WarmReaders.clear();
+}
+
+int PreloadManager::GetHitCount()
+{
+  return m_HitCount;
+}
+
+int PreloadManager::GetMissCount()
+{
+  return m_MissCount;
+}
+
+void PreloadManager::StartWarmUp()
+{
+  DR_PROFILE_FUNCTION();
+  m_WarmReaders.clear();
+  m_PredictedFiles.clear();
+
+  qint64 l_usedBytes = 0;
+  for (const SpeakerHistory &i_speaker : qAsConst(m_Speakers))
+  {
+    for (const QString &i_emote : PredictEmotes(i_speaker))
+    {
+      for (const QString &i_file : GetSpriteFiles(i_speaker.mCharacter, i_emote))
+      {
+        m_PredictedFiles.insert(i_file);
+        if (m_WarmReaders.contains(i_file) || mk2::SpriteCache::find(i_file))
+        {
+          continue;
+        }
+
+        const QImageReader l_imageReader(i_file);
+        const QSize l_size = l_imageReader.size();
+        if (!l_size.isValid() || l_imageReader.imageCount() <= 0)
+        {
+          continue;
+        }
+        const qint64 l_projectedBytes = qint64(l_size.width()) * l_size.height() * l_imageReader.imageCount() * 4;
+        if (l_usedBytes + l_projectedBytes > m_ByteBudget || !MemoryManager::get().EnsureHeadroom(l_projectedBytes, MemoryManager::Priority::Speculative))
+        {
+          continue;
+        }
+        l_usedBytes += l_projectedBytes;
+
+        // decoded sprites are handed to the memory cache, so they outlive the reader
+        mk2::SpriteReader::ptr l_reader(new mk2::SpriteCachingReader);
+        l_reader->set_decode_priority(mk2::SpriteDecodeScheduler::Priority::Speculative);
+        l_reader->set_file_name(i_file);
+        m_WarmReaders.insert(i_file, l_reader);
+      }
+    }
+  }
+  DR_PROFILE_COUNTER("preload warm bytes", l_usedBytes);
+}
+
+QStringList PreloadManager::PredictEmotes(const SpeakerHistory &t_speaker)
+{
+  // the emote used last is the most likely one, then the most used ones
+  QStringList l_emoteList = t_speaker.mEmoteUsage.keys();
+  std::stable_sort(l_emoteList.begin(), l_emoteList.end(), [&t_speaker](const QString &t_a, const QString &t_b) {
+    return t_speaker.mEmoteUsage.value(t_a) > t_speaker.mEmoteUsage.value(t_b);
+  });
+  l_emoteList.removeOne(t_speaker.mLastEmote);
+  l_emoteList.prepend(t_speaker.mLastEmote);
+  return l_emoteList.mid(0, s_EmotesPerSpeaker);
+}
+
+QStringList PreloadManager::GetSpriteFiles(QString t_character, QString t_emote)
+{
+  QStringList l_fileList;
+  if (t_character.isEmpty() || t_emote.isEmpty())
+  {
+    return l_fileList;
+  }
+
+  AOApplication *l_app = AOApplication::getInstance();
+  for (const QString &i_file : {l_app->get_character_sprite_idle_path(t_character, t_emote), l_app->get_character_sprite_talk_path(t_character, t_emote)})
+  {
+    if (!i_file.isEmpty() && !l_fileList.contains(i_file))
+    {
+      l_fileList.append(i_file);
+    }
+  }
+  return l_fileList;
+}
+
+void PreloadManager::RecordStatistics()
+{
+  DR_PROFILE_COUNTER("preload hits", m_HitCount);
+  DR_PROFILE_COUNTER("preload misses", m_MissCount);
+  qDebug().noquote() << QString("[preload] %1 hits, %2 misses").arg(m_HitCount).arg(m_MissCount);
+}
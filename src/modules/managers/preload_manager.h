@@ -0,0 +1,82 @@
+#ifndef PRELOADMANAGER_H
+#define PRELOADMANAGER_H
+
+#include "mk2/spritereader.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+/*!
+ * Speculative preloading of character sprites.
+ *
+ * Recent speakers of the current area and the emotes they used are kept as a
+ * short history. Once the courtroom has been quiet for a moment, the idle and
+ * talking sprites of each speaker's most likely next emotes are decoded at
+ * speculative priority, within a byte budget. A real message cancels whatever
+ * it does not need right away.
+ */
+class PreloadManager : public QObject
+{
+  Q_OBJECT
+public:
+  PreloadManager(const PreloadManager&) = delete;
+
+  static PreloadManager& get()
+  {
+    return s_Instance;
+  }
+
+  qint64 GetByteBudget();
+  // 0 disables preloading
+  void SetByteBudget(qint64 t_bytes);
+
+  // e.g. when moving to another area
+  void ResetHistory();
+
+  // must be called before the readers of the message are created; counts hits, cancels warming and learns from it
+  void RecordMessage(QString t_character, QString t_emote);
+
+  // warming starts once no other message arrived for a short while
+  void ScheduleWarmUp();
+  void CancelWarmUp();
+
+  int GetHitCount();
+  int GetMissCount();
+
+private slots:
+  void StartWarmUp();
+
+private:
+  PreloadManager() {}
+  static PreloadManager s_Instance;
+
+  struct SpeakerHistory
+  {
+    QString mCharacter;
+    QString mLastEmote;
+    QHash<QString, int> mEmoteUsage;
+  };
+
+  QStringList PredictEmotes(const SpeakerHistory &t_speaker);
+  QStringList GetSpriteFiles(QString t_character, QString t_emote);
+  void RecordStatistics();
+
+  // most recent first
+  QList<SpeakerHistory> m_Speakers = {};
+  // file name -> reader keeping the decode alive
+  QHash<QString, mk2::SpriteReader::ptr> m_WarmReaders = {};
+  // files named by the last prediction, whether they were already cached or not
+  QSet<QString> m_PredictedFiles = {};
+  qint64 m_ByteBudget = 128ll * 1024 * 1024;
+
+  QTimer *m_WarmUpTimer = nullptr;
+
+  int m_HitCount = 0;
+  int m_MissCount = 0;
+};
+
+#endif // PRELOADMANAGER_H
@@ -4,6 +4,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QCoreApplication>
 #include <QFile>
 #include <aoapplication.h>
 #include <QDir>
@@ -58,6 +59,9 @@ QString ReplayManager::getReplayImagePath(QString t_package, QString t_category,
 
 void ReplayManager::RecordingStart()
 {
+  RecordingFinalize();
+  m_ReplayOperationsRecorded.clear();
+
   QString l_FileName = QDateTime::currentDateTime().toString("yyyy-MM-dd (hh.mm.ss.z)'.json'");
   m_FilePathOutput =  AOApplication::getInstance()->get_base_path() + "replays/" + l_FileName;
   m_TimerRecorder.start();
@@ -68,8 +72,7 @@ void ReplayManager::RecordChangeMusic(QString t_music)
   ReplayOperation lNewOperation = ReplayOperation("bgm");
   lNewOperation.mTimestamp = m_TimerRecorder.elapsed();
   lNewOperation.mVariables["track"] = t_music;
-  m_ReplayOperationsRecorded.append(lNewOperation);
-  RecordingSave();
+  RecordOperation(lNewOperation);
 }
 
 void ReplayManager::RecordChangeBackground(QString t_bgn)
@@ -77,8 +80,7 @@ void ReplayManager::RecordChangeBackground(QString t_bgn)
   ReplayOperation lNewOperation = ReplayOperation("bg");
   lNewOperation.mTimestamp = m_TimerRecorder.elapsed();
   lNewOperation.mVariables["name"] = t_bgn;
-  m_ReplayOperationsRecorded.append(lNewOperation);
-  RecordingSave();
+  RecordOperation(lNewOperation);
 }
 
 void ReplayManager::RecordMessageIC(ICMessageData *m_Message)
@@ -100,8 +102,7 @@ void ReplayManager::RecordMessageIC(ICMessageData *m_Message)
   lNewOperation.mVariables["flip"] = QString::number(m_Message->m_IsFlipped);
   lNewOperation.mVariables["effect"] = m_Message->m_EffectData.mName;
   lNewOperation.mVariables["shout"] = QString::number(m_Message->m_ShoutModifier);
-  m_ReplayOperationsRecorded.append(lNewOperation);
-  RecordingSave();
+  RecordOperation(lNewOperation);
 }
 
 void ReplayManager::RecordMessageOOC(QString t_name, QString t_message)
@@ -110,8 +111,7 @@ void ReplayManager::RecordMessageOOC(QString t_name, QString t_message)
   lNewOperation.mTimestamp = m_TimerRecorder.elapsed();
   lNewOperation.mVariables["name"] = t_name;
   lNewOperation.mVariables["msg"] = t_message;
-  m_ReplayOperationsRecorded.append(lNewOperation);
-  RecordingSave();
+  RecordOperation(lNewOperation);
 }
 
 void ReplayManager::RecordChangeWeather(QString t_weather)
@@ -129,8 +129,7 @@ void ReplayManager::RecordChangeHour(QString t_hour)
   ReplayOperation lNewOperation = ReplayOperation("clock");
   lNewOperation.mTimestamp = m_TimerRecorder.elapsed();
   lNewOperation.mVariables["hour"] = t_hour;
-  m_ReplayOperationsRecorded.append(lNewOperation);
-  RecordingSave();
+  RecordOperation(lNewOperation);
 }
 
 void ReplayManager::RecordChangeTOD(QString t_tod)
@@ -138,29 +137,78 @@ void ReplayManager::RecordChangeTOD(QString t_tod)
   ReplayOperation lNewOperation = ReplayOperation("TOD");
   lNewOperation.mTimestamp = m_TimerRecorder.elapsed();
   lNewOperation.mVariables["value"] = t_tod;
-  m_ReplayOperationsRecorded.append(lNewOperation);
+  RecordOperation(lNewOperation);
+}
+
+void ReplayManager::RecordOperation(ReplayOperation t_operation)
+{
+  m_ReplayOperationsRecorded.append(t_operation);
+
+  m_JournalPending.append(QJsonDocument(OperationToJson(t_operation)).toJson(QJsonDocument::Compact));
+  m_JournalPending.append('\n');
+  if(m_JournalFlushTimer == nullptr)
+  {
+    // owned by the application so that it is gone before static teardown
+    m_JournalFlushTimer = new QTimer(QCoreApplication::instance());
+    m_JournalFlushTimer->setSingleShot(true);
+    m_JournalFlushTimer->setInterval(1000);
+    QObject::connect(m_JournalFlushTimer, &QTimer::timeout, [this]() { RecordingFlush(); });
+  }
+  if(!m_JournalFlushTimer->isActive()) m_JournalFlushTimer->start();
+}
+
+void ReplayManager::RecordingFlush()
+{
+  if(m_JournalFlushTimer != nullptr) m_JournalFlushTimer->stop();
+  if(m_JournalPending.isEmpty()) return;
+
+  if(!m_JournalFile.isOpen())
+  {
+    m_JournalFile.setFileName(m_FilePathOutput);
+    if (!m_JournalFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      qDebug() << "Failed to open replay journal for writing.";
+      return;
+    }
+  }
+
+  m_JournalFile.write(m_JournalPending);
+  m_JournalFile.flush();
+  m_JournalPending.clear();
+}
+
+void ReplayManager::RecordingFinalize()
+{
+  if(m_ReplayOperationsRecorded.isEmpty()) return;
+
+  RecordingFlush();
+  m_JournalFile.close();
   RecordingSave();
 }
 
+QJsonObject ReplayManager::OperationToJson(const ReplayOperation &t_operation)
+{
+  QJsonObject rNewOperations;
+  rNewOperations["op"] = t_operation.mOperation;
+  rNewOperations["time"] = t_operation.mTimestamp;
+
+  QMap<QString, QString>::const_iterator i;
+  for (i = t_operation.mVariables.constBegin(); i != t_operation.mVariables.constEnd(); ++i)
+  {
+    rNewOperations[i.key()] = i.value();
+  }
+  return rNewOperations;
+}
+
 void ReplayManager::RecordingSave()
 {
   QJsonObject lReplayJson;
 
   QJsonArray lReplayOperations;
 
-  for(ReplayOperation rOperation : m_ReplayOperationsRecorded)
+  for(const ReplayOperation &rOperation : m_ReplayOperationsRecorded)
   {
-    QJsonObject rNewOperations;
-    rNewOperations["op"] = rOperation.mOperation;
-    rNewOperations["time"] = rOperation.mTimestamp;
-
-    QMap<QString, QString>::const_iterator i;
-    for (i = rOperation.mVariables.constBegin(); i != rOperation.mVariables.constEnd(); ++i)
-    {
-      rNewOperations[i.key()] = i.value();
-    }
-
-    lReplayOperations.append(rNewOperations);
+    lReplayOperations.append(OperationToJson(rOperation));
   }
 
   lReplayJson["script"] = lReplayOperations;
@@ -2,6 +2,8 @@
 #define REPLAYMANAGER_H
 
 #include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
 #include <QTimer>
 #include <datatypes.h>
 #include "scene_manager.h"
@@ -28,6 +30,10 @@ public:
   void RecordChangeGamemode(QString t_gamemode);
   void RecordChangeHour(QString t_hour);
   void RecordChangeTOD(QString t_tod);
+  // operations are appended to a journal while recording; the replay is only
+  // rewritten in its final form once the recording is finalized
+  void RecordingFlush();
+  void RecordingFinalize();
   void RecordingSave();
 
 
@@ -54,6 +60,9 @@ private:
   ReplayManager() {}
   static ReplayManager s_Instance;
 
+  void RecordOperation(ReplayOperation t_operation);
+  static QJsonObject OperationToJson(const ReplayOperation &t_operation);
+
   ReplayScene *p_SceneReplay = nullptr;
 
   //Packages
@@ -64,6 +73,9 @@ private:
   QElapsedTimer m_TimerRecorder;
   QString m_FilePathOutput = "replays/replay.json";
   QVector<ReplayOperation> m_ReplayOperationsRecorded = {};
+  QFile m_JournalFile;
+  QByteArray m_JournalPending = {};
+  QTimer *m_JournalFlushTimer = nullptr;
 
   //Playback
   int m_PlaybackPositionIndex = 0;
@@ -7,7 +7,9 @@
 #include "datatypes.h"
 #include "modules/background/background_reader.h"
 #include "modules/background/legacy_background_reader.h"
+#include "modules/managers/memory_manager.h"
 #include "modules/managers/variable_manager.h"
+#include "modules/debug/profiler.h"
 
 SceneManager SceneManager::s_Instance;
 
@@ -80,12 +82,20 @@ AOLabel *SceneManager::GetTransition()
 
 void SceneManager::RenderTransition()
 {
-  QImage image(p_WidgetViewport->scene()->sceneRect().size().toSize(), QImage::Format_ARGB32);
+  DR_PROFILE_FUNCTION();
+  QImage image(p_WidgetViewport->scene()->sceneRect().size().toSize(), QImage::Format_ARGB32_Premultiplied);
   image.fill(Qt::transparent);
 
   QPainter painter(&image);
   p_WidgetViewport->scene()->render(&painter);
   p_WidgetTransition->setPixmap(QPixmap::fromImage(image));
+
+  // the snapshot stays on the transition widget until the next one replaces it
+  if(m_TransitionMemoryConsumer == 0)
+  {
+    m_TransitionMemoryConsumer = MemoryManager::get().RegisterConsumer("transition snapshot", MemoryManager::Priority::Active);
+  }
+  MemoryManager::get().SetUsage(m_TransitionMemoryConsumer, image.sizeInBytes());
 }
 
 void SceneManager::AnimateTransition()
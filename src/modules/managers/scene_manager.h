@@ -132,6 +132,7 @@ private:
   DRGraphicsView *p_WidgetViewport = nullptr;
 
   int m_FadeDuration = 200;
+  int m_TransitionMemoryConsumer = 0;
 
   //Current Scene
   QString m_BackgroundName = "";
@@ -35,6 +35,9 @@ void GraphicObjectAnimator::updateAnimation()
   mTargetWidget->setX(posX);
   mTargetWidget->setY(posY);
 
+  // the animated size is read while painting, so the item needs a repaint on every tick
+  mTargetWidget->update();
+
   if(lScale != 9999999)
   {
     double l_scale = (lScale / 100);
@@ -5,6 +5,8 @@
 #include "courtroom.h"
 #include "drpather.h"
 #include "file_functions.h"
+#include "mk2/spritediskcache.h"
+#include "modules/files/asset_index.h"
 #include "modules/managers/character_manager.h"
 #include "modules/managers/pathing_manager.h"
 #include "modules/managers/replay_manager.h"
@@ -32,6 +34,18 @@ void AOApplication::reload_packages()
   PathingManager::get().refreshLocalPackages();
   package_names = PathingManager::get().getPackageNames().toVector();
   m_disabled_packages = PathingManager::get().getDisabledPackages().toVector();
+
+  QStringList l_mount_list;
+  for (const QString &i_package : qAsConst(package_names))
+  {
+    if (!m_disabled_packages.contains(i_package))
+    {
+      l_mount_list.append(get_package_path(i_package));
+    }
+  }
+  l_mount_list.append(get_base_path());
+  AssetIndex::get().SetMounts(l_mount_list);
+  mk2::SpriteDiskCache::warm_up(l_mount_list);
 }
 
 
@@ -71,6 +85,11 @@ QString AOApplication::get_package_or_base_path(QString p_path)
 
 QString AOApplication::get_package_or_base_file(QString p_filepath)
 {
+  if (const std::optional<QString> l_file_path = AssetIndex::get().FindFile(p_filepath))
+  {
+    return l_file_path->isEmpty() ? get_base_path() + p_filepath : l_file_path.value();
+  }
+
   for (int i=0; i< package_names.size(); i++)
   {
     if(!m_disabled_packages.contains(package_names.at(i)))
@@ -102,7 +121,8 @@ QVector<QString> AOApplication::get_all_package_and_base_paths(QString p_path)
     if(!m_disabled_packages.contains(package_names.at(i)))
     {
       QString package_path = get_package_path(package_names.at(i))  + p_path;
-      if(dir_exists(package_path))
+      const std::optional<QString> l_indexed_path = AssetIndex::get().ResolveDirectory(package_path);
+      if(l_indexed_path.has_value() ? !l_indexed_path->isEmpty() : dir_exists(package_path))
       {
         found_paths.append(package_path);
       }
@@ -172,7 +192,17 @@ QString AOApplication::get_case_sensitive_path(QString p_file)
 }
 #else
 {
-  if (QFile::exists(p_file) || p_file.isEmpty())
+  if (p_file.isEmpty())
+  {
+    return p_file;
+  }
+
+  if (const std::optional<QString> l_indexed_path = AssetIndex::get().ResolvePath(p_file))
+  {
+    return l_indexed_path->isEmpty() ? p_file : l_indexed_path.value();
+  }
+
+  if (QFile::exists(p_file))
   {
     return p_file;
   }
@@ -218,6 +248,26 @@ QString AOApplication::find_asset_path(QStringList p_file_list, QStringList p_ex
 {
   for (const QString &i_file : qAsConst(p_file_list))
   {
+    // the asset index answers for everything under a mounted root
+    bool l_is_indexed = false;
+    for (const QString &i_extension : qAsConst(p_extension_list))
+    {
+      const std::optional<QString> l_indexed_path = AssetIndex::get().ResolveFile(i_file + i_extension);
+      if (!l_indexed_path.has_value())
+      {
+        break;
+      }
+      l_is_indexed = true;
+      if (!l_indexed_path->isEmpty())
+      {
+        return l_indexed_path.value();
+      }
+    }
+    if (l_is_indexed)
+    {
+      continue;
+    }
+
     const QDir l_dir(get_case_sensitive_path(QFileInfo(i_file).absolutePath()));
 
     for (const QString &i_extension : qAsConst(p_extension_list))
@@ -15,6 +15,7 @@
 #include "lobby.h"
 #include "version.h"
 #include "modules/networking/json_packet.h"
+#include "modules/debug/profiler.h"
 
 #include <modules/managers/game_manager.h>
 
@@ -91,10 +92,19 @@ void AOApplication::_p_handle_server_state_update(DRServerSocket::ConnectionStat
 void AOApplication::_p_handle_server_packet(DRPacket p_packet)
 {
   const QString l_header = p_packet.get_header();
-  const QStringList l_content = p_packet.get_content();
+  DR_PROFILE_SCOPE_DYNAMIC("packet " + l_header);
 
   if (l_header != "checkconnection")
-    qDebug().noquote() << "S/R:" << p_packet.to_string();
+    qDebug().noquote() << "S/R:" << p_packet.to_string(true);
+
+  // json payloads are the largest packets by far and only their first field is read
+  if (l_header == "JSN")
+  {
+    JsonPacket::ProcessJson(p_packet.get_content_at(0));
+    return;
+  }
+
+  const QStringList l_content = p_packet.get_content();
 
   if (l_header == "decryptor")
   {
@@ -289,10 +299,6 @@ void AOApplication::_p_handle_server_packet(DRPacket p_packet)
     m_lobby->set_loading_value(loading_value);
     send_server_packet(DRPacket("RD"));
   }
-  else if (l_header == "JSN")
-  {
-    JsonPacket::ProcessJson(l_content.at(0));
-  }
   else if (l_header == "LIST_REASON")
   {
     int prompt = l_content.at(0).toInt();
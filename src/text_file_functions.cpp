@@ -10,6 +10,7 @@
 #include "drtheme.h"
 #include "commondefs.h"
 #include "file_functions.h"
+#include "modules/files/ini_cache.h"
 #include "modules/theme/thememanager.h"
 #include "utils.h"
 
@@ -72,32 +73,10 @@ void AOApplication::append_note(QString p_line, QString p_file)
  */
 QString AOApplication::read_ini(QString p_identifier, QString p_path)
 {
-  QFile ini;
-  ini.setFileName(p_path);
-  if (!ini.open(QIODevice::ReadOnly))
+  const std::shared_ptr<const IniDocument> l_document = IniCache::get().GetDocument(p_path);
+  if (!l_document)
     return "";
-
-  QTextStream in(&ini);
-  QString result = "";
-  while (!in.atEnd())
-  {
-    QString f_line = in.readLine().trimmed();
-
-    if (!f_line.startsWith(p_identifier))
-      continue;
-
-    QStringList line_elements = f_line.split("=");
-
-    if (line_elements.at(0).trimmed() != p_identifier)
-      continue;
-    if (line_elements.size() < 2)
-      continue;
-    result = line_elements.at(1).trimmed();
-    break;
-  }
-
-  ini.close();
-  return result;
+  return l_document->GetValue(p_identifier);
 }
 
 QPoint AOApplication::get_button_spacing(QString p_identifier, QString p_file)
@@ -219,32 +198,14 @@ QString AOApplication::get_stylesheet(QString target_tag, QString p_file)
   if (path.isEmpty())
     return "";
 
-  QFile design_ini(path);
-  if (!design_ini.open(QIODevice::ReadOnly))
+  const std::shared_ptr<const IniDocument> l_document = IniCache::get().GetDocument(path);
+  if (!l_document)
     return "";
 
-  QTextStream in(&design_ini);
   QString f_text;
-  bool tag_found = false;
-
-  while (!in.atEnd())
-  {
-    QString line = in.readLine();
-    if (line.startsWith(target_tag, Qt::CaseInsensitive))
-    {
-      tag_found = true;
-      continue;
-    }
-
-    if (tag_found)
-    {
-      if ((line.startsWith("[") && line.endsWith("]")))
-        break;
-      f_text.append(line);
-    }
-  }
+  for (const QString &line : l_document->GetSectionLines(target_tag))
+    f_text.append(line);
 
-  design_ini.close();
   return f_text; // This is the empty string if no appends took place
 }
 
@@ -322,44 +283,27 @@ QVector<QStringList> AOApplication::get_highlight_colors()
   if (path.isEmpty())
     return QVector<QStringList>();
 
-  QFile design_ini(path);
-  if (!design_ini.open(QIODevice::ReadOnly))
+  const std::shared_ptr<const IniDocument> l_document = IniCache::get().GetDocument(path);
+  if (!l_document)
     return QVector<QStringList>();
 
-  QTextStream in(&design_ini);
-  bool tag_found = false;
   QVector<QStringList> f_vec;
-
-  while (!in.atEnd())
+  for (const QString &line : l_document->GetSectionLines("[HIGHLIGHTS]"))
   {
-    QString line = in.readLine();
-
-    if (line.startsWith("[HIGHLIGHTS]", Qt::CaseInsensitive))
-    {
-      tag_found = true;
-      continue;
-    }
-
-    if (tag_found)
-    {
-      if ((line.startsWith("[") && line.endsWith("]")))
-        break;
-      // Syntax
-      // OpenercharCloserchar = Color, Shown
-      // Shown is 1 if the character should be displayed in IC, 0 otherwise.
-      // If not present, assume 1.
-      QString chars = line.split("=")[0].trimmed();
-      QString chars_parameters = line.mid(line.indexOf("=") + 1);
-      QStringList parameters = chars_parameters.split(",");
-      for (int i = 0; i < parameters.size(); i++)
-        parameters[i] = parameters[i].trimmed();
-      if (parameters.size() == 1)
-        parameters.append("1");
-      f_vec.append({chars, parameters[0], parameters[1]});
-    }
+    // Syntax
+    // OpenercharCloserchar = Color, Shown
+    // Shown is 1 if the character should be displayed in IC, 0 otherwise.
+    // If not present, assume 1.
+    QString chars = line.split("=")[0].trimmed();
+    QString chars_parameters = line.mid(line.indexOf("=") + 1);
+    QStringList parameters = chars_parameters.split(",");
+    for (int i = 0; i < parameters.size(); i++)
+      parameters[i] = parameters[i].trimmed();
+    if (parameters.size() == 1)
+      parameters.append("1");
+    f_vec.append({chars, parameters[0], parameters[1]});
   }
 
-  design_ini.close();
   return f_vec; // Could be an empty vector if no appends were made
 }
 
@@ -373,36 +317,18 @@ QString AOApplication::get_spbutton(QString p_tag, int index)
   if (path.isEmpty())
     return "";
 
-  QFile design_ini(path);
-  if (!design_ini.open(QIODevice::ReadOnly))
+  const std::shared_ptr<const IniDocument> l_document = IniCache::get().GetDocument(path);
+  if (!l_document)
     return "";
 
-  QTextStream in(&design_ini);
-  bool tag_found = false;
   QString res;
-
-  while (!in.atEnd())
+  for (const QString &line : l_document->GetSectionLines(p_tag))
   {
-    QString line = in.readLine();
-
-    if (line.startsWith(p_tag, Qt::CaseInsensitive))
-    {
-      tag_found = true;
-      continue;
-    }
-
-    if (tag_found)
-    {
-      if ((line.startsWith("[") && line.endsWith("]")))
-        break;
-
-      QStringList line_contents = line.split("=");
-      if (line_contents.at(0).trimmed() == QString::number(index))
-        res = line_contents.at(1);
-    }
+    QStringList line_contents = line.split("=");
+    if (line_contents.at(0).trimmed() == QString::number(index))
+      res = line_contents.at(1);
   }
 
-  design_ini.close();
   return res; // Could be the empty string if no matches were found.
 }
 
@@ -448,11 +374,10 @@ QStringList AOApplication::get_sfx_list()
 // be found
 QVariant AOApplication::read_char_ini(QString p_chr, QString p_group, QString p_key, QVariant p_def)
 {
-  QSettings s(get_character_path(p_chr, CHARACTER_CHAR_INI), QSettings::IniFormat);
-  s.setIniCodec("UTF-8");
-  utils::QSettingsKeyFetcher l_fetcher(s);
-  s.beginGroup(l_fetcher.lookup_group(p_group));
-  return s.value(l_fetcher.lookup_value(p_key), p_def);
+  const std::shared_ptr<const IniSettings> l_settings = IniCache::get().GetSettings(get_character_path(p_chr, CHARACTER_CHAR_INI));
+  if (!l_settings)
+    return p_def;
+  return l_settings->GetValue(p_group, p_key, p_def);
 }
 
 QVariant AOApplication::read_char_ini(QString p_chr, QString p_group, QString p_key)
@@ -12,6 +12,7 @@
 #include "aoapplication.h"
 #include "commondefs.h"
 #include "datatypes.h"
+#include "drchatlogview.h"
 #include "drstickerviewer.h"
 #include "drtextedit.h"
 #include "drtheme.h"
@@ -143,6 +144,15 @@ void set_font(QWidget *p_widget, QString p_identifier, QString ini_file, AOAppli
   p_widget->setStyleSheet(style_sheet_string);
 }
 
+static bool is_font_outlined(QString p_identifier, QString p_ini_file, AOApplication *ao_app)
+{
+  if(ao_app->current_theme->m_jsonLoaded)
+  {
+    return ThemeManager::get().mCurrentThemeReader.GetFontData(COURTROOM, p_identifier).outline;
+  }
+  return ao_app->get_font_property(p_identifier + "_outline", p_ini_file) == 1;
+}
+
 void set_drtextedit_font(DRTextEdit *p_widget, QString p_identifier, QString p_ini_file, AOApplication *ao_app)
 {
   QString l_scene = "lobby";
@@ -151,23 +161,22 @@ void set_drtextedit_font(DRTextEdit *p_widget, QString p_identifier, QString p_i
   set_font(p_widget, p_identifier, p_ini_file, ao_app);
 
   // Do outlines
-  bool outline;
-
-  if(ao_app->current_theme->m_jsonLoaded)
-  {
-    outline = ThemeManager::get().mCurrentThemeReader.GetFontData(COURTROOM, p_identifier).outline;
-  }
-  else
-  {
-    outline = (ao_app->get_font_property(p_identifier + "_outline", p_ini_file) == 1);
-  }
-  p_widget->set_outline(outline);
+  p_widget->set_outline(is_font_outlined(p_identifier, p_ini_file, ao_app));
 
   // alignment
   set_text_alignment_or_default(p_widget, p_identifier, p_ini_file, ao_app, "text_alignment", Qt::AlignLeft,
                                 Qt::AlignTop);
 }
 
+void set_drchatlogview_font(DRChatLogView *p_widget, QString p_identifier, QString p_ini_file, AOApplication *ao_app)
+{
+  set_font(p_widget, p_identifier, p_ini_file, ao_app);
+  p_widget->set_outline(is_font_outlined(p_identifier, p_ini_file, ao_app));
+
+  set_text_alignment_or_default(p_widget, p_identifier, p_ini_file, ao_app, "text_alignment", Qt::AlignLeft,
+                                Qt::AlignTop);
+}
+
 /**
  * @brief set_stylesheet
  * @param p_widget The widget to apply the stylesheet to
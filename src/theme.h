@@ -3,6 +3,7 @@
 // src
 #include "datatypes.h"
 class AOApplication;
+class DRChatLogView;
 class DRStickerViewer;
 class DRTextEdit;
 
@@ -17,6 +18,7 @@ void set_text_alignment(QWidget *widget, widgetFontStruct font_data, AOApplicati
 void set_font(QWidget *widget, QString identifier, QString ini_file, AOApplication *ao_app);
 void setThemeFont(QWidget *widget, widgetFontStruct font_data, AOApplication *ao_app);
 void set_drtextedit_font(DRTextEdit *widget, QString identifier, QString ini_file, AOApplication *ao_app);
+void set_drchatlogview_font(DRChatLogView *widget, QString identifier, QString ini_file, AOApplication *ao_app);
 
 void setShownameFont(DRTextEdit *widget, QString identifier, QString align, AOApplication *ao_app);
 